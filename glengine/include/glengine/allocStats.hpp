@@ -0,0 +1,75 @@
+#ifndef GLENGINE_ALLOC_STATS_HPP
+#define GLENGINE_ALLOC_STATS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace GLEngine {
+    /**
+     * @brief Compteurs d'allocations sur le tas par image, par thread et par zone de trace.
+     *
+     * Avec l'option CMake GLENGINE_ALLOC_STATS, glengine remplace les opérateurs
+     * new / delete globaux du programme : chaque allocation est comptée dans des
+     * compteurs propres au thread, sans verrou, et attribuée à la zone de trace
+     * ouverte (GLENGINE_TRACE). Sans l'option, les compteurs restent à zéro.
+     */
+    class AllocStats {
+    public:
+        struct Counters {
+            uint64_t allocations = 0;
+            uint64_t frees = 0;
+            uint64_t bytes = 0;
+        };
+
+        struct ThreadCounters {
+            const char* name;
+            Counters counters;
+        };
+
+        struct ZoneCounters {
+            // nullptr for allocations made outside any zone
+            const char* zone;
+            Counters counters;
+        };
+
+        // Threads past the limit share one overflow slot, zones past it are counted without a name
+        static constexpr size_t MAX_THREADS = 64;
+        static constexpr size_t MAX_ZONES = 64;
+
+        // Allocations of the calling thread are not counted while it lives (tooling around the frame)
+        class Exclude {
+        public:
+            Exclude();
+            ~Exclude();
+
+            Exclude(const Exclude&) = delete;
+            Exclude& operator=(const Exclude&) = delete;
+        };
+
+        static bool isEnabled();
+        // Names must outlive the counters, string literals in practice
+        static void setThreadName(const char* name);
+
+        // Closes the current frame, the allocations seen until now become getFrame(); does not allocate
+        static void endFrame();
+
+        static const Counters& getFrame();
+        static const Counters& getMax();
+        static const Counters& getTotal();
+        static uint64_t getFrameCount();
+        // Threads and zones that allocated during the last frame, sorted by bytes
+        static const std::vector<ThreadCounters>& getFrameThreads();
+        static const std::vector<ZoneCounters>& getFrameZones();
+
+        // "alloc" JSON object: per-frame mean and max of each counter
+        static void writeJson(std::ostream& out);
+
+        // Allocator hooks, also usable for allocators that bypass operator new (ImGui)
+        static void onAllocate(size_t bytes);
+        static void onFree();
+    };
+}
+
+#endif // GLENGINE_ALLOC_STATS_HPP
\ No newline at end of file
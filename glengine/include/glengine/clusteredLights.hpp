@@ -0,0 +1,84 @@
+#ifndef GLENGINE_CLUSTERED_LIGHTS_HPP
+#define GLENGINE_CLUSTERED_LIGHTS_HPP
+
+#include <glengine/frameArena.hpp>
+#include <glengine/shader.hpp>
+#include <glengine/streamBuffer.hpp>
+#include <memory_resource>
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace GLEngine {
+    struct PointLight {
+        glm::vec3 position;
+        float radius;
+        glm::vec3 color;
+        float intensity;
+    };
+
+    /**
+     * @brief Eclairage "clustered forward" : les lumières ponctuelles sont réparties
+     * sur CPU dans une grille de froxels (tuiles écran x tranches de profondeur
+     * logarithmiques), puis envoyées aux shaders via trois buffer textures qui lisent
+     * la région courante d'un StreamBuffer.
+     */
+    class ClusteredLights {
+    public:
+        // The per-build light ranges come from sub-arena 0 of arena when given
+        ClusteredLights(unsigned int tilesX = 16, unsigned int tilesY = 9, unsigned int slices = 24,
+                        FrameArena* arena = nullptr);
+        ~ClusteredLights();
+
+        std::vector<PointLight>& getLights() { return lights; }
+        const std::vector<PointLight>& getLights() const { return lights; }
+
+        void build(const glm::mat4& view, float fovy, float aspect, float nearPlane, float farPlane);
+        bool upload(StreamBuffer& stream);
+        // viewport is x, y, width, height in pixels of the view the clusters were built for
+        void bind(const Shader& shader, int firstTextureUnit, const glm::ivec4& viewport) const;
+        void cleanup();
+
+        unsigned int getClusterCount() const { return tilesX * tilesY * slices; }
+        size_t getLightIndexCount() const { return lightIndices.size(); }
+        unsigned int getMaxLightsPerCluster() const { return maxLightsPerCluster; }
+
+        // CPU side results, one (offset, count) pair per cluster
+        const std::vector<uint32_t>& getClusterGrid() const { return clusterGrid; }
+        const std::vector<uint32_t>& getLightIndices() const { return lightIndices; }
+
+    private:
+        struct ClusterRange {
+            uint16_t x0, x1, y0, y1, z0, z1;
+        };
+
+        unsigned int tilesX, tilesY, slices;
+        std::vector<PointLight> lights;
+
+        // Tile boundary planes through the eye, stored SoA and padded to a multiple of 4
+        std::vector<float> planesX, planesXz, planesY, planesYz;
+        float boundsFovy, boundsAspect;
+
+        FrameArena* arena;
+        std::pmr::vector<ClusterRange> ranges;
+        std::pmr::vector<uint8_t> visible;
+        std::vector<uint32_t> clusterGrid;
+        std::vector<uint32_t> lightIndices;
+        std::vector<float> distances;
+        unsigned int maxLightsPerCluster;
+
+        float nearPlane, farPlane;
+        float zScale, zBias;
+
+        // Texture views over the stream buffer, offsets are in texels of each format
+        uint64_t streamGeneration;
+        unsigned int lightTexture, gridTexture, indexTexture;
+        int lightOffset, gridOffset, indexOffset;
+        bool uploaded;
+
+        void setupBoundaries(float fovy, float aspect);
+        bool computeRange(const glm::vec3& center, float radius, ClusterRange& range);
+    };
+}
+
+#endif // GLENGINE_CLUSTERED_LIGHTS_HPP
\ No newline at end of file
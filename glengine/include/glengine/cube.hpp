@@ -1,6 +1,8 @@
 #ifndef GLENGINE_CUBE_HPP
 #define GLENGINE_CUBE_HPP
 
+#include <glengine/gpuMemory.hpp>
+
 namespace GLEngine {
     class Cube {
     public:
@@ -11,7 +13,8 @@ namespace GLEngine {
         void cleanup();
         
     private:
-        unsigned int VAO, VBO;
+        unsigned int VAO, VBO, EBO;
+        GpuMemory::Handle memoryHandle;
         
         void setupCube(float size);
     };
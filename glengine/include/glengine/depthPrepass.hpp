@@ -0,0 +1,75 @@
+#ifndef GLENGINE_DEPTH_PREPASS_HPP
+#define GLENGINE_DEPTH_PREPASS_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace GLEngine {
+    /**
+     * @brief Pré-passe de profondeur optionnelle et mesure de l'overdraw.
+     *
+     * Des requêtes GL_SAMPLES_PASSED entourent la passe de profondeur et la passe
+     * d'éclairage ; leurs résultats sont lus quelques images plus tard pour ne pas
+     * bloquer le pipeline. En mode AUTO la pré-passe est activée quand la
+     * complexité de profondeur mesurée dépasse le seuil.
+     */
+    class DepthPrepass {
+    public:
+        enum class Mode {
+            OFF,
+            ON,
+            AUTO
+        };
+
+        DepthPrepass(float threshold = 1.5f, int probeInterval = 60);
+        ~DepthPrepass();
+
+        bool beginFrame(bool allowed = true);
+        void beginDepthPass();
+        void endDepthPass();
+        void beginShadingPass();
+        void endShadingPass();
+        void cleanup();
+
+        void setMode(Mode _mode) { mode = _mode; }
+        Mode getMode() const { return mode; }
+        void setThreshold(float _threshold) { threshold = _threshold; }
+        float getThreshold() const { return threshold; }
+
+        bool isActive() const { return active; }
+        float getDepthComplexity() const { return depthComplexity; }
+        float getShadedFragmentsPerPixel() const { return shadedPerPixel; }
+        uint64_t getShadedFragments() const { return shadedFragments; }
+
+    private:
+        struct QuerySet {
+            unsigned int depthQuery;
+            unsigned int shadingQuery;
+            bool depthUsed;
+            bool pending;
+        };
+
+        static constexpr int QUERY_LATENCY = 3;
+
+        Mode mode;
+        float threshold;
+        int probeInterval;
+        bool active;
+        bool autoEnabled;
+        uint64_t frameIndex;
+
+        std::array<QuerySet, QUERY_LATENCY> querySets;
+        int current;
+        // False when every set was still in flight, the frame is not counted
+        bool measuring;
+
+        float depthComplexity;
+        float shadedPerPixel;
+        uint64_t shadedFragments;
+        uint64_t coveredPixels;
+
+        bool collect(QuerySet& set);
+    };
+}
+
+#endif // GLENGINE_DEPTH_PREPASS_HPP
\ No newline at end of file
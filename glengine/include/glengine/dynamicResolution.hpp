@@ -0,0 +1,82 @@
+#ifndef GLENGINE_DYNAMIC_RESOLUTION_HPP
+#define GLENGINE_DYNAMIC_RESOLUTION_HPP
+
+#include <array>
+#include <cstddef>
+#include <glengine/gpuMemory.hpp>
+#include <glengine/shader.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief Résolution dynamique pilotée par le temps GPU.
+     *
+     * La scène est rendue dans un FBO hors écran dont seule une partie, fixée par
+     * l'échelle courante, est utilisée. Des requêtes GL_TIME_ELAPSED, lues quelques
+     * images plus tard, mesurent le temps GPU de la scène ; l'échelle est ajustée
+     * vers le budget avec une zone morte (hystérésis). L'image est ensuite agrandie
+     * vers le framebuffer par défaut avec un filtre de netteté.
+     */
+    class DynamicResolution {
+    public:
+        DynamicResolution(float budgetMs = 16.0f, float minScale = 0.5f, float maxScale = 1.0f);
+        ~DynamicResolution();
+
+        void beginFrame(int outputWidth, int outputHeight);
+        void endFrame();
+        void present(const Shader& upscaleShader, unsigned int framebuffer = 0) const;
+        void cleanup();
+
+        void setAutoScale(bool _autoScale) { autoScale = _autoScale; }
+        bool isAutoScale() const { return autoScale; }
+        void setScale(float _scale);
+        float getScale() const { return scale; }
+        void setBudget(float _budgetMs) { budgetMs = _budgetMs; }
+        float getBudget() const { return budgetMs; }
+        void setSharpness(float _sharpness) { sharpness = _sharpness; }
+        float getSharpness() const { return sharpness; }
+        float getMinScale() const { return minScale; }
+        float getMaxScale() const { return maxScale; }
+
+        float getGpuTime() const { return gpuTimeMs; }
+        unsigned int getFramebuffer() const { return FBO; }
+        int getRenderWidth() const { return renderWidth; }
+        int getRenderHeight() const { return renderHeight; }
+        size_t getMemorySize() const;
+
+    private:
+        struct TimerQuery {
+            unsigned int query;
+            float scale;
+            bool pending;
+        };
+
+        static constexpr int QUERY_LATENCY = 3;
+        static constexpr int SETTLE_SAMPLES = 4;
+
+        unsigned int FBO;
+        unsigned int colorTexture, depthRenderbuffer;
+        unsigned int emptyVAO;
+        GpuMemory::Handle memoryHandle;
+        int width, height;
+        int renderWidth, renderHeight;
+
+        float budgetMs;
+        float minScale, maxScale;
+        float scale;
+        float hysteresis;
+        float sharpness;
+        bool autoScale;
+
+        std::array<TimerQuery, QUERY_LATENCY> queries;
+        int current;
+        // False when every query was still in flight, the frame is not timed
+        bool timing;
+        float gpuTimeMs;
+        int samples;
+
+        void resize(int _width, int _height);
+        bool collect(TimerQuery& timer);
+    };
+}
+
+#endif // GLENGINE_DYNAMIC_RESOLUTION_HPP
\ No newline at end of file
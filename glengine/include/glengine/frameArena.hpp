@@ -0,0 +1,64 @@
+#ifndef GLENGINE_FRAME_ARENA_HPP
+#define GLENGINE_FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace GLEngine {
+    /**
+     * @brief Allocateur linéaire pour les données transitoires d'une image.
+     *
+     * Chaque thread du JobSystem a sa sous-arène, exposée comme std::pmr::memory_resource :
+     * une allocation avance un pointeur, une libération ne fait rien. Les arènes sont
+     * doublées : beginFrame() bascule sur l'autre moitié et ne réinitialise que celle de
+     * l'image N-2, les données de l'image précédente restent donc lisibles. Quand un bloc
+     * déborde, un bloc supplémentaire est pris sur le tas, puis les blocs sont fusionnés
+     * au prochain passage pour que l'image suivante tienne dans un seul.
+     */
+    class FrameArena {
+    public:
+        struct Stats {
+            size_t used = 0;
+            size_t highWater = 0;
+            size_t capacity = 0;
+            uint64_t overflows = 0;
+        };
+
+        explicit FrameArena(unsigned int threadCount = 1, size_t blockSize = 256u << 10);
+        ~FrameArena();
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        // GL thread, while no job allocates
+        void beginFrame();
+
+        // Stable across frames; a sub-arena is not thread-safe, one thread at a time (job thread `thread` during jobs)
+        std::pmr::memory_resource* getResource(unsigned int thread = 0);
+        unsigned int getThreadCount() const { return (unsigned int)threads.size(); }
+        uint64_t getFrame() const { return frame; }
+
+        // used is the last finished frame, summed over threads
+        Stats getStats() const;
+        Stats getStats(unsigned int thread) const;
+
+        // Drops storage of an earlier frame so the vector allocates from the current one, at the same capacity
+        template<typename T>
+        static void recycle(std::pmr::vector<T>& vector) {
+            size_t capacity = vector.capacity();
+            std::pmr::vector<T>(vector.get_allocator()).swap(vector);
+            vector.reserve(capacity);
+        }
+
+    private:
+        class ThreadArena;
+
+        std::vector<std::unique_ptr<ThreadArena>> threads;
+        uint64_t frame;
+    };
+}
+
+#endif // GLENGINE_FRAME_ARENA_HPP
\ No newline at end of file
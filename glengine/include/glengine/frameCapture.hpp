@@ -0,0 +1,89 @@
+#ifndef GLENGINE_FRAME_CAPTURE_HPP
+#define GLENGINE_FRAME_CAPTURE_HPP
+
+#include <glad/glad.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <glengine/gpuMemory.hpp>
+#include <glengine/threadPool.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief Captures d'écran et enregistrement sans bloquer le pipeline.
+     *
+     * glReadPixels écrit dans un anneau de pixel pack buffers ; chaque lecture est
+     * suivie d'un glFenceSync et n'est mappée que lorsque la fence est signalée,
+     * quelques images plus tard. L'encodage PNG/JPEG (stb_image_write) se fait sur
+     * un pool de threads. Si le GPU ou les encodeurs ont du retard, les images
+     * enregistrées sont abandonnées plutôt que de ralentir le rendu.
+     */
+    class FrameCapture {
+    public:
+        enum class Format {
+            PNG,
+            JPEG
+        };
+
+        FrameCapture(int ringSize = 3, unsigned int workerCount = 2);
+        ~FrameCapture();
+
+        void requestScreenshot(const std::string& path);
+        void startRecording(const std::string& directory, Format format);
+        void stopRecording();
+        bool isRecording() const { return recording; }
+
+        void capture(int width, int height, unsigned int framebuffer = 0);
+        void flush();
+        void cleanup();
+
+        void setJpegQuality(int quality) { jpegQuality = quality; }
+        int getJpegQuality() const { return jpegQuality; }
+
+        bool hasPendingReadbacks() const;
+        uint64_t getCapturedFrames() const { return capturedFrames; }
+        uint64_t getDroppedFrames() const { return droppedFrames; }
+        uint64_t getEncodedFrames() const { return encodedFrames.load(); }
+        uint64_t getFailedFrames() const { return failedFrames.load(); }
+        size_t getPendingEncodes() const { return encoders.getPendingCount(); }
+
+    private:
+        struct Slot {
+            unsigned int pbo;
+            size_t capacity;
+            GLsync fence;
+            int width, height;
+            std::string path;
+            Format format;
+        };
+
+        std::vector<Slot> slots;
+        int ringSize;
+        int next;
+        GpuMemory::Handle memoryHandle;
+
+        std::string screenshotPath;
+        bool recording;
+        std::string recordingDirectory;
+        Format recordingFormat;
+        uint64_t recordingIndex;
+        int jpegQuality;
+
+        uint64_t capturedFrames;
+        uint64_t droppedFrames;
+        std::atomic<uint64_t> encodedFrames;
+        std::atomic<uint64_t> failedFrames;
+
+        ThreadPool encoders;
+        std::mutex bufferMutex;
+        std::vector<std::vector<unsigned char>> freeBuffers;
+
+        void collect(bool block);
+        void encode(std::vector<unsigned char> pixels, int width, int height, const std::string& path, Format format);
+    };
+}
+
+#endif // GLENGINE_FRAME_CAPTURE_HPP
\ No newline at end of file
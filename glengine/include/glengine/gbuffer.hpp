@@ -0,0 +1,55 @@
+#ifndef GLENGINE_GBUFFER_HPP
+#define GLENGINE_GBUFFER_HPP
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <glengine/gpuMemory.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief G-buffer compact pour le rendu différé.
+     *
+     * - attachement 0 : normale monde encodée en octaèdre (RG16)
+     * - attachement 1 : albédo + intensité spéculaire (RGBA8)
+     * - attachement 2 : brillance du matériau, log2(shininess) / 10 (R8)
+     * - profondeur : DEPTH24_STENCIL8, la position est reconstruite à partir de celle-ci
+     *
+     * Le rendu peut n'occuper qu'une partie des textures (setRenderSize) afin que la
+     * résolution dynamique ne réalloue pas le G-buffer à chaque changement d'échelle.
+     */
+    class GBuffer {
+    public:
+        GBuffer();
+        ~GBuffer();
+
+        void resize(int width, int height);
+        void setRenderSize(int width, int height);
+        void bindForWriting() const;
+        // Normal, albedo, depth then material on consecutive units
+        void bindTextures(int firstTextureUnit) const;
+        void blitDepthTo(unsigned int framebuffer) const;
+        void drawFullscreen() const;
+        void cleanup();
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+        int getRenderWidth() const { return renderWidth; }
+        int getRenderHeight() const { return renderHeight; }
+        // Offset and size, in texture coordinates, of a viewport of the render area
+        glm::vec4 getTexCoordRect(const glm::ivec4& viewport) const;
+        size_t getMemorySize() const;
+
+    private:
+        unsigned int FBO;
+        unsigned int normalTexture, albedoTexture, materialTexture, depthTexture;
+        unsigned int emptyVAO;
+        GpuMemory::Handle memoryHandle;
+        int width, height;
+        int renderWidth, renderHeight;
+    };
+
+    bool computeLightScissor(const glm::vec3& center, float radius, const glm::mat4& view,
+                             const glm::mat4& projection, int width, int height, glm::ivec4& rect);
+}
+
+#endif // GLENGINE_GBUFFER_HPP
\ No newline at end of file
@@ -0,0 +1,107 @@
+#ifndef GLENGINE_GEOMETRY_POOL_HPP
+#define GLENGINE_GEOMETRY_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <glengine/gpuMemory.hpp>
+
+namespace GLEngine {
+    struct Vertex;
+
+    /**
+     * @brief Grands buffers de sommets et d'indices partagés par tous les meshes.
+     *
+     * Chaque mesh reçoit une plage de sommets et une plage d'indices, allouées par
+     * une free-list triée qui fusionne les blocs libres voisins. Les indices restent
+     * relatifs au premier sommet du mesh et sont dessinés avec
+     * glDrawElementsBaseVertex : déplacer une plage (croissance, défragmentation)
+     * ne demande donc aucune réécriture, et un seul VAO sert à toute la scène.
+     */
+    class GeometryPool {
+    public:
+        using Handle = uint32_t;
+        static constexpr Handle INVALID_HANDLE = 0xFFFFFFFFu;
+
+        struct Range {
+            unsigned int vertexOffset = 0;
+            unsigned int vertexCount = 0;
+            unsigned int indexOffset = 0;
+            unsigned int indexCount = 0;
+        };
+
+        struct Stats {
+            size_t allocations = 0;
+            size_t vertexCapacity = 0;
+            size_t vertexUsed = 0;
+            size_t indexCapacity = 0;
+            size_t indexUsed = 0;
+            size_t freeBlocks = 0;
+            uint64_t grows = 0;
+            uint64_t defragmentations = 0;
+        };
+
+        GeometryPool(size_t initialVertices = 1u << 18, size_t initialIndices = 1u << 20);
+        ~GeometryPool();
+
+        Handle allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+        void release(Handle handle);
+        // shrink also gives back free capacity above the initial size
+        void defragment(bool shrink = false);
+        void cleanup();
+
+        const Range& getRange(Handle handle) const { return allocations[handle].range; }
+        unsigned int getVAO() const { return VAO; }
+        unsigned int getDepthVAO() const { return depthVAO; }
+        unsigned int getVertexBuffer() const { return VBO; }
+        // Changes whenever buffers are reallocated or ranges move
+        uint64_t getGeneration() const { return generation; }
+        float getFragmentation() const;
+        size_t getReclaimableBytes() const;
+        Stats getStats() const;
+
+    private:
+        // Free-list of [offset, offset + size) blocks, keyed by offset so neighbours merge
+        class RangeAllocator {
+        public:
+            void reset(size_t capacity);
+            bool allocate(size_t size, size_t& offset);
+            void release(size_t offset, size_t size);
+            void grow(size_t newCapacity);
+
+            size_t getCapacity() const { return capacity; }
+            size_t getFree() const;
+            size_t getLargestFree() const;
+            size_t getBlockCount() const { return freeBlocks.size(); }
+
+        private:
+            std::map<size_t, size_t> freeBlocks;
+            size_t capacity = 0;
+        };
+
+        struct Allocation {
+            Range range;
+            bool live = false;
+        };
+
+        unsigned int VAO, VBO, EBO;
+        unsigned int depthVAO, positionVBO;
+        RangeAllocator vertexAllocator;
+        RangeAllocator indexAllocator;
+        std::vector<Allocation> allocations;
+        std::vector<Handle> freeHandles;
+        size_t initialVertices;
+        size_t initialIndices;
+        uint64_t generation;
+        uint64_t growCount;
+        uint64_t defragmentCount;
+        GpuMemory::Handle memoryHandle;
+
+        void createBuffers(size_t vertexCapacity, size_t indexCapacity);
+        void setupVertexArrays();
+        void reserve(size_t vertexCapacity, size_t indexCapacity);
+    };
+}
+
+#endif // GLENGINE_GEOMETRY_POOL_HPP
\ No newline at end of file
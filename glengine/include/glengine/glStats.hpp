@@ -0,0 +1,47 @@
+#ifndef GLENGINE_GL_STATS_HPP
+#define GLENGINE_GL_STATS_HPP
+
+#include <cstdint>
+#include <ostream>
+
+namespace GLEngine {
+    /**
+     * @brief Compteurs d'appels OpenGL par image.
+     *
+     * Avec l'option CMake GLENGINE_GL_STATS, install() remplace chaque pointeur
+     * de fonction glad par une enveloppe générée depuis glad.h qui compte les
+     * draws, triangles, changements d'état, uniforms et octets envoyés, et vérifie
+     * glGetError après chaque appel dans les builds de debug. Sans l'option, les
+     * appels vont directement au driver et les compteurs restent à zéro.
+     */
+    class GLStats {
+    public:
+        struct Counters {
+            uint64_t calls = 0;
+            uint64_t drawCalls = 0;
+            uint64_t triangles = 0;
+            uint64_t stateChanges = 0;
+            uint64_t uniformUpdates = 0;
+            uint64_t bufferBytes = 0;
+            uint64_t textureBytes = 0;
+            uint64_t errors = 0;
+        };
+
+        // After gladLoadGLLoader, on the thread owning the context; false when compiled out
+        static bool install();
+        static bool isEnabled();
+
+        // Closes the current frame, the counters seen until now become getFrame()
+        static void endFrame();
+
+        static const Counters& getFrame();
+        static const Counters& getMax();
+        static const Counters& getTotal();
+        static uint64_t getFrameCount();
+
+        // "gl" JSON object: per-frame mean and max of each counter
+        static void writeJson(std::ostream& out);
+    };
+}
+
+#endif // GLENGINE_GL_STATS_HPP
\ No newline at end of file
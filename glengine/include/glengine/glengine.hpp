@@ -10,9 +10,6 @@
 #include <GL/gl.h>
 #endif
 
-#include <iostream>
-#include <stdexcept>
-
 /**
  * \namespace GLEngine
  * @brief Espace de nom pour GLEngine
@@ -20,30 +17,7 @@
  * blabla
  */
 namespace GLEngine {
-	// static void GLClearError() {
-	// 	while (glGetError() != GL_NO_ERROR);
-	// }
-
-	// static bool GLLogCall(const char* function, const char* file, int line) {
-	// 	while (GLenum error = glGetError()) {
-	// 		std::cout << "[OpenGL Error] (" << error << ") " << function << std::endl
-	// 			<< file <<" L" << line << std::endl;
-	// 		return false;
-	// 	}
-	// 	return true;
-	// }
 } // namespace GLEngine
 
-#define ASSERT(x) if ((!x)) throw std::runtime_error("a gl error occured");
-
-#ifdef DEBUG
-#define GLCALL(x) GLEngine::GLClearError();\
-	x;\
-	ASSERT(GLEngine::GLLogCall(#x, __FILE__, __LINE__));
-#else
-#define GLCALL(x) x;
-#endif
-
-
 #endif // ! GLENGINE_HPP__
 
@@ -0,0 +1,66 @@
+#ifndef GLENGINE_GPU_MEMORY_HPP
+#define GLENGINE_GPU_MEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GLEngine {
+    /**
+     * @brief Comptabilité de la mémoire GPU allouée par le moteur.
+     *
+     * Chaque buffer, texture ou renderbuffer est déclaré avec une catégorie, un
+     * propriétaire et sa taille estimée (celle demandée au driver, sans padding).
+     * Les totaux servent au budget global ; la mémoire rapportée par le driver
+     * (GL_NVX_gpu_memory_info, GL_ATI_meminfo) est lue à part quand elle existe.
+     */
+    class GpuMemory {
+    public:
+        using Handle = uint32_t;
+        static constexpr Handle INVALID_HANDLE = 0xFFFFFFFFu;
+
+        enum class Category {
+            GEOMETRY,
+            TEXTURE,
+            RENDER_TARGET,
+            STREAMING,
+            READBACK,
+            COUNT
+        };
+
+        struct Resource {
+            Category category;
+            std::string owner;
+            size_t bytes;
+        };
+
+        struct DriverInfo {
+            const char* source = nullptr;
+            size_t totalBytes = 0;
+            size_t availableBytes = 0;
+        };
+
+        static Handle track(Category category, const std::string& owner, size_t bytes);
+        static void resize(Handle handle, size_t bytes);
+        // Resets handle to INVALID_HANDLE, invalid handles are ignored
+        static void release(Handle& handle);
+
+        static size_t getTotal();
+        static size_t getTotal(Category category);
+        static size_t getResourceCount();
+        // Snapshot sorted by size, for display; reuses the vector and its strings across calls
+        static void getResources(std::vector<Resource>& resources);
+        static const char* getCategoryName(Category category);
+
+        // 0 disables the budget
+        static void setBudget(size_t bytes);
+        static size_t getBudget();
+        static bool isOverBudget();
+
+        // GL thread; false without a vendor memory extension
+        static bool queryDriver(DriverInfo& info);
+    };
+}
+
+#endif // GLENGINE_GPU_MEMORY_HPP
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define GRID3D_HPP
 
 #include <glengine/shader.hpp>
+#include <glengine/gpuMemory.hpp>
 #include <vector>
 #include <glm/glm.hpp>
 
@@ -16,6 +17,7 @@ namespace GLEngine {
         
     private:
         unsigned int VAO, VBO;
+        GpuMemory::Handle memoryHandle;
         std::vector<float> vertices;
         size_t gridVertexCount;
         size_t axesVertexCount;
@@ -0,0 +1,118 @@
+#ifndef GLENGINE_JOB_SYSTEM_HPP
+#define GLENGINE_JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GLEngine {
+    /**
+     * @brief Système de jobs fork-join à vol de tâches.
+     *
+     * Chaque thread possède sa file : il y empile et dépile ses jobs par la fin,
+     * les threads inactifs volent par le début. Les threads extérieurs (le thread
+     * OpenGL) partagent la file 0. Attendre un compteur ne bloque jamais ce
+     * thread : il exécute des jobs en attendant, ce qui permet aussi d'attendre
+     * depuis un job (fork-join imbriqué).
+     */
+    class JobSystem {
+    public:
+        // Pending jobs of one fork; children may be added while it is running
+        class Counter {
+        public:
+            bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+        private:
+            friend class JobSystem;
+            std::atomic<uint32_t> pending{0};
+        };
+
+        // Called around every job while set; times are steady_clock nanoseconds
+        using TraceHook = void (*)(const char* name, unsigned int thread, uint64_t startNs, uint64_t endNs, void* user);
+
+        // One worker per core besides the calling thread
+        static constexpr unsigned int AUTO_WORKERS = ~0u;
+
+        // With no worker every job runs on the thread that waits for it
+        explicit JobSystem(unsigned int workerCount = AUTO_WORKERS);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        void run(Counter& counter, std::function<void()> job, const char* name = nullptr);
+        void wait(Counter& counter);
+        bool tryRunOne();
+        // body(first, last) over [0, count), about four chunks per thread but never below minGrain items;
+        // chunks reference the caller's body, nothing is copied or allocated
+        template<typename Body>
+        void parallelFor(size_t count, const Body& body, size_t minGrain = 1, const char* name = nullptr) {
+            parallelForRange(count, &body, [](const void* function, size_t first, size_t last) {
+                (*(const Body*)function)(first, last);
+            }, minGrain, name);
+        }
+        void shutdown();
+
+        void setTraceHook(TraceHook hook, void* user = nullptr);
+
+        unsigned int getWorkerCount() const { return (unsigned int)workers.size(); }
+        unsigned int getThreadCount() const { return (unsigned int)queues.size(); }
+        // 0 outside the workers, so it can index per-thread data of size getThreadCount()
+        unsigned int getThreadIndex() const;
+        uint64_t getExecutedCount() const { return executed.load(std::memory_order_relaxed); }
+        uint64_t getStealCount() const { return steals.load(std::memory_order_relaxed); }
+
+    private:
+        using RangeFunction = void (*)(const void* body, size_t first, size_t last);
+
+        // Either an owned function (run) or a chunk of a parallelFor body
+        struct Job {
+            std::function<void()> function;
+            RangeFunction range = nullptr;
+            const void* body = nullptr;
+            size_t first = 0;
+            size_t last = 0;
+            Counter* counter = nullptr;
+            const char* name = nullptr;
+        };
+
+        // Ring buffer that only grows, a steady job load never reaches the allocator
+        struct alignas(64) WorkQueue {
+            std::mutex mutex;
+            std::vector<Job> jobs;
+            size_t head = 0;
+            size_t count = 0;
+
+            void pushBack(Job&& job);
+            bool popBack(Job& job);
+            bool popFront(Job& job);
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<size_t> queuedJobs;
+        std::atomic<unsigned int> sleepingWorkers;
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        bool stopping;
+
+        std::atomic<TraceHook> traceHook;
+        std::atomic<void*> traceUser;
+        std::atomic<uint64_t> executed;
+        std::atomic<uint64_t> steals;
+
+        void push(Job&& job);
+        void parallelForRange(size_t count, const void* body, RangeFunction range, size_t minGrain, const char* name);
+        bool pop(unsigned int thread, Job& job);
+        void execute(Job& job, unsigned int thread);
+        void workerLoop(unsigned int thread);
+    };
+}
+
+#endif // GLENGINE_JOB_SYSTEM_HPP
\ No newline at end of file
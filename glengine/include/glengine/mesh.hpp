@@ -3,7 +3,11 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <glengine/geometryPool.hpp>
+#include <glengine/gpuMemory.hpp>
+#include <glengine/textureCache.hpp>
 
 namespace GLEngine {
     struct Vertex {
@@ -12,24 +16,96 @@ namespace GLEngine {
         glm::vec2 texCoords;
     };
 
+    /**
+     * @brief Matériau issu d'un fichier MTL (newmtl / Kd / Ks / Ns / map_Kd).
+     *
+     * La couleur diffuse teinte objectColor ; une brillance nulle laisse la valeur
+     * globale de l'interface.
+     */
+    struct Material {
+        std::string name;
+        glm::vec3 diffuse = glm::vec3(1.0f);
+        float specular = 1.0f;
+        float shininess = 0.0f;
+        std::string diffuseMapPath;
+        TextureCache::Handle diffuseMap = TextureCache::INVALID_HANDLE;
+        // Unique across loaded meshes, used as a sort key
+        uint32_t id = 0;
+    };
+
+    /**
+     * @brief Plage d'indices d'un groupe OBJ (o / g) utilisant un seul matériau.
+     */
+    struct SubMesh {
+        std::string name;
+        unsigned int indexOffset;
+        unsigned int indexCount;
+        unsigned int material;
+    };
+
     class Mesh {
     public:
         Mesh();
         ~Mesh();
         
         void loadFromFile(const std::string& objPath);
+        void loadFromFile(const std::string& objPath, GeometryPool& geometryPool);
         void draw() const;
+        void drawDepthOnly() const;
+        void drawNormals(unsigned int step = 1);
+        void loadTextures(TextureCache& textureCache);
         void cleanup();
+
+        // Frees the GPU geometry but keeps bounds and materials; restore() reads the OBJ again,
+        // or uploads geometry already read from getSourcePath() on another thread
+        bool evict();
+        bool restore();
+        bool restore(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+        bool isResident() const { return resident; }
+        const std::string& getSourcePath() const { return sourcePath; }
+        size_t getGeometryBytes() const;
+
+        size_t getVertexCount() const { return vertexCount; }
+        uint64_t getRevision() const { return revision; }
+        unsigned int getVAO() const { return pool ? pool->getVAO() : VAO; }
+        // Offsets inside the bound buffers, non-zero only for meshes stored in a GeometryPool
+        int getBaseVertex() const { return pool ? (int)pool->getRange(poolHandle).vertexOffset : 0; }
+        unsigned int getFirstIndex() const { return pool ? pool->getRange(poolHandle).indexOffset : 0; }
+        const glm::vec3& getBoundsMin() const { return boundsMin; }
+        const glm::vec3& getBoundsMax() const { return boundsMax; }
+        const std::vector<SubMesh>& getSubMeshes() const { return subMeshes; }
+        const std::vector<Material>& getMaterials() const { return materials; }
         
         static std::vector<std::string> getObjFiles(const std::string& directory);
         
     private:
         unsigned int VAO, VBO, EBO;
+        unsigned int normalsVAO;
+        unsigned int depthVAO, positionVBO;
+        unsigned int normalsStep;
+        GpuMemory::Handle memoryHandle;
+        std::string sourcePath;
+        GeometryPool* sourcePool;
+        bool resident;
         size_t indexCount;
+        size_t vertexCount;
+        uint64_t revision;
         bool hasTexCoords;
+        GeometryPool* pool;
+        GeometryPool::Handle poolHandle;
+        uint64_t normalsGeneration;
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+        std::vector<SubMesh> subMeshes;
+        std::vector<Material> materials;
         
+        void uploadGeometry(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+        void releaseGeometry();
         void setupBuffers(const std::vector<Vertex>& vertices,
                          const std::vector<unsigned int>& indices);
+        void setupNormalsAttributes(unsigned int step);
+        void computeBounds(const std::vector<Vertex>& vertices);
+        void assignMaterialIds();
     };
 }
 
@@ -0,0 +1,81 @@
+#ifndef GLENGINE_MESH_RESIDENCY_HPP
+#define GLENGINE_MESH_RESIDENCY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <glengine/geometryPool.hpp>
+#include <glengine/mesh.hpp>
+#include <glengine/threadPool.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief Maintient la mémoire GPU sous le budget de GpuMemory en évinçant des meshes.
+     *
+     * Les meshes visibles sont marqués à chaque image. Un mesh évincé qui redevient
+     * visible est relu depuis son fichier OBJ sur un thread de chargement, puis envoyé
+     * au GPU par update() ; il reste non résident d'ici là. Tant que le total dépasse le budget,
+     * le mesh invisible depuis le plus longtemps (LRU) libère sa géométrie, puis le
+     * pool est compacté pour rendre la place au driver.
+     */
+    class MeshResidency {
+    public:
+        explicit MeshResidency(GeometryPool& geometryPool);
+
+        void add(Mesh* mesh);
+        void remove(Mesh* mesh);
+        void clear();
+
+        // Evicted meshes are still culled with their bounds and marked here, as are shadow casters out of view
+        void markVisible(const Mesh* mesh);
+        // Returns true when geometry was restored or evicted, restored meshes are drawn from the next frame
+        bool update();
+
+        size_t getMeshCount() const { return entries.size(); }
+        size_t getEvictedCount() const;
+        uint64_t getEvictionCount() const { return evictionCount; }
+        uint64_t getRestoreCount() const { return restoreCount; }
+
+    private:
+        struct Entry {
+            Mesh* mesh;
+            uint64_t lastVisible;
+            // Read in flight, 0 when none
+            uint64_t restoreRequest;
+            bool visible;
+            bool restoreFailed;
+        };
+
+        // Produced by the loader thread, uploaded by update()
+        struct Restored {
+            uint64_t request;
+            const Mesh* mesh;
+            std::vector<Vertex> vertices;
+            std::vector<unsigned int> indices;
+        };
+
+        GeometryPool& pool;
+        std::vector<Entry> entries;
+        std::unordered_map<const Mesh*, size_t> indices;
+        // Reused by update() so a scene over budget does not allocate every frame
+        std::vector<Entry*> candidates;
+        std::vector<std::unique_ptr<Restored>> uploads;
+        uint64_t frame;
+        uint64_t nextRequest;
+        uint64_t evictionCount;
+        uint64_t restoreCount;
+
+        // Shared with the loader thread
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Restored>> completed;
+
+        // A single thread: restores are rare and bound by the disk, the cores belong to the JobSystem.
+        // Declared last so it is joined before the rest is destroyed
+        ThreadPool loader;
+    };
+}
+
+#endif // GLENGINE_MESH_RESIDENCY_HPP
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef GLENGINE_MULTI_VIEW_HPP
+#define GLENGINE_MULTI_VIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glengine/gpuMemory.hpp>
+#include <glengine/orbitalCamera.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief Plusieurs vues d'une même scène dans une seule cible de rendu.
+     *
+     * Chaque vue a son rectangle (glViewport + glScissor) et son bloc uniforme « Camera »,
+     * tous rangés dans un seul uniform buffer et liés par glBindBufferRange. Les plans des
+     * frustums de toutes les vues sont stockés côte à côte : cull() teste une boîte contre
+     * toutes les vues d'un coup et rend un masque, la scène n'est parcourue qu'une fois.
+     */
+    class MultiView {
+    public:
+        enum class Layout {
+            SINGLE,
+            // Two by two, views numbered left to right then top to bottom
+            QUAD
+        };
+
+        static constexpr unsigned int MAX_VIEWS = 4;
+        // Uniform buffer binding point of the Camera block
+        static constexpr unsigned int CAMERA_BINDING = 0;
+
+        MultiView();
+        ~MultiView();
+
+        MultiView(const MultiView&) = delete;
+        MultiView& operator=(const MultiView&) = delete;
+
+        static unsigned int getViewCount(Layout layout);
+        // x, y, width, height in pixels of a width x height target, origin bottom left
+        static glm::ivec4 getRect(Layout layout, unsigned int view, int width, int height);
+
+        // GL thread: one camera per view of the layout, valid until the frame is drawn; uploads every camera block
+        void beginFrame(Layout layout, const OrbitalCamera* const* cameras, int width, int height);
+        // Viewport, scissor and camera block of one view, the scissor test stays enabled
+        void bind(unsigned int view) const;
+        // Back to the whole target, scissor test disabled
+        void endFrame() const;
+
+        // Any thread between beginFrame() and the next one: bit v is set when the world-space box may be seen by view v
+        uint32_t cull(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+        // View-space depth of a world-space point divided by the far plane of view v
+        float getDepth(unsigned int view, const glm::vec3& point) const {
+            return glm::dot(depthPlanes[view], glm::vec4(point, 1.0f));
+        }
+
+        unsigned int getViewCount() const { return viewCount; }
+        const glm::ivec4& getRect(unsigned int view) const { return rects[view]; }
+        const OrbitalCamera& getCamera(unsigned int view) const { return *cameras[view]; }
+
+        void cleanup();
+
+    private:
+        // std140 layout of the Camera block
+        struct CameraBlock {
+            glm::mat4 view;
+            glm::mat4 projection;
+            glm::vec4 position;
+        };
+
+        unsigned int UBO;
+        GpuMemory::Handle memoryHandle;
+        size_t blockStride;
+        std::vector<unsigned char> staging;
+
+        unsigned int viewCount;
+        int width, height;
+        const OrbitalCamera* cameras[MAX_VIEWS];
+        glm::ivec4 rects[MAX_VIEWS];
+        glm::vec4 depthPlanes[MAX_VIEWS];
+
+        // Six planes per view, structure of arrays so one box is tested against all of them in a single loop
+        static constexpr unsigned int MAX_PLANES = MAX_VIEWS * 6;
+        float planeX[MAX_PLANES], planeY[MAX_PLANES], planeZ[MAX_PLANES], planeW[MAX_PLANES];
+        float absX[MAX_PLANES], absY[MAX_PLANES], absZ[MAX_PLANES];
+    };
+}
+
+#endif // GLENGINE_MULTI_VIEW_HPP
\ No newline at end of file
@@ -7,6 +7,23 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace GLEngine {
+    /**
+     * @brief Plans du frustum, normales vers l'intérieur (gauche, droite, bas, haut, proche, lointain).
+     */
+    struct Frustum {
+        glm::vec4 planes[6];
+
+        // World-space axis-aligned box, conservative near the corners
+        bool intersects(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+    };
+
+	/**
+	 * @brief Caméra orbitale autour d'un point focal.
+	 *
+	 * Les déplacements demandés par les événements d'entrée sont cumulés et
+	 * appliqués une seule fois par image dans update(). Les matrices et le
+	 * frustum ne sont recalculés que lorsque la caméra ou la projection change.
+	 */
 	class OrbitalCamera {
 	public:
         enum class Movement {
@@ -17,14 +34,34 @@ namespace GLEngine {
         };
 
         OrbitalCamera(glm::vec3 _position = glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3 _focus = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 _up = glm::vec3(0.0f, -1.0f, 0.0f));
-        glm::mat4 getViewMatrix();
+        const glm::mat4& getViewMatrix() const;
+        const glm::mat4& getProjectionMatrix() const;
+        const glm::mat4& getViewProjectionMatrix() const;
+        const Frustum& getFrustum() const;
         glm::vec3 getPosition() const;
+        glm::vec3 getFocus() const;
         float getFov() const;
+        float getAspect() const { return aspect; }
+        float getNearPlane() const { return nearPlane; }
+        float getFarPlane() const { return farPlane; }
+
+        // Accumulated until the next update()
         void orbit(float xoffset, float yoffset);
         void dolly(float offset);
         void track(float offset);
         void pedestal(float offset);
         void zoom(float offset);
+        // Applies the pending input, returns whether the camera moved
+        bool update();
+
+        // Drops the pending input
+        void setLookAt(const glm::vec3& newPosition, const glm::vec3& newFocus);
+        // A zero-sized framebuffer (minimized window) keeps the previous aspect
+        void setViewport(int width, int height);
+        void setClipPlanes(float nearDistance, float farDistance);
+        // Orthographic projection showing halfHeight world units above and below the focus, 0 switches back to perspective
+        void setOrthographic(float halfHeight);
+        bool isOrthographic() const { return orthoHalfHeight > 0.0f; }
 
     private:
         glm::vec3 position;
@@ -37,7 +74,31 @@ namespace GLEngine {
         glm::vec3 right;
         glm::vec3 camFocusVector;
 
+        float aspect;
+        float nearPlane;
+        float farPlane;
+        float orthoHalfHeight;
+
+        glm::vec2 pendingOrbit;
+        float pendingDolly;
+        float pendingTrack;
+        float pendingPedestal;
+        float pendingZoom;
+
+        mutable glm::mat4 view;
+        mutable glm::mat4 projection;
+        mutable glm::mat4 viewProjection;
+        mutable Frustum frustum;
+        mutable bool viewDirty;
+        mutable bool projectionDirty;
+        mutable bool viewProjectionDirty;
+
+        void applyOrbit(float xoffset, float yoffset);
+        void applyDolly(float offset);
+        void applyTrack(float offset);
+        void applyPedestal(float offset);
+        void applyZoom(float offset);
         void updateCameraVectors();
 	};
 }
-#endif
+#endif
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef GLENGINE_REDRAW_SCHEDULER_HPP
+#define GLENGINE_REDRAW_SCHEDULER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace GLEngine {
+    /**
+     * @brief Décide si une image doit être redessinée en mode "render on demand".
+     *
+     * Chaque source d'invalidation demande quelques images (le temps que ImGui se
+     * stabilise) ; sans demande en attente, waitEvents() endort le thread dans
+     * glfwWaitEventsTimeout.
+     */
+    class RedrawScheduler {
+    public:
+        enum class Source {
+            INPUT,
+            UI,
+            RESIZE,
+            RESOURCE,
+            ANIMATION,
+            COUNT
+        };
+
+        RedrawScheduler(int settleFrames = 3, double idleTimeout = 1.0);
+
+        void setEnabled(bool enabled);
+        bool isEnabled() const { return enabled; }
+        void setAnimating(bool animating);
+
+        void invalidate(Source source);
+        void invalidateAsync(Source source);
+
+        void waitEvents();
+        bool beginFrame();
+
+        uint64_t getCount(Source source) const { return counts[(size_t)source]; }
+        uint64_t getFramesRendered() const { return framesRendered; }
+        uint64_t getFramesSkipped() const { return framesSkipped; }
+        static const char* getSourceName(Source source);
+
+    private:
+        int settleFrames;
+        double idleTimeout;
+        bool enabled;
+        bool animating;
+        int pendingFrames;
+
+        std::atomic<uint32_t> asyncSources;
+        std::array<uint64_t, (size_t)Source::COUNT> counts;
+        uint64_t framesRendered;
+        uint64_t framesSkipped;
+
+        void consumeAsync();
+    };
+}
+
+#endif // GLENGINE_REDRAW_SCHEDULER_HPP
\ No newline at end of file
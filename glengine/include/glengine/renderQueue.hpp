@@ -0,0 +1,115 @@
+#ifndef GLENGINE_RENDER_QUEUE_HPP
+#define GLENGINE_RENDER_QUEUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glengine/frameArena.hpp>
+#include <glengine/jobSystem.hpp>
+#include <glengine/mesh.hpp>
+#include <glengine/shader.hpp>
+#include <glengine/stateCache.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief Draw enregistré, exécuté plus tard sur le thread OpenGL.
+     *
+     * Les matrices sont lues à l'exécution et doivent rester valides jusque-là.
+     */
+    struct RenderCommand {
+        const Shader* shader;
+        const Material* material;
+        unsigned int vao;
+        unsigned int indexOffset;
+        unsigned int indexCount;
+        int baseVertex;
+        const glm::mat4* model;
+        const glm::mat3* normalMatrix;
+    };
+
+    /**
+     * @brief File de draws enregistrable depuis plusieurs threads.
+     *
+     * Chaque thread remplit son propre Recorder, sans verrou, avec des paquets
+     * (clé de tri 64 bits passe / shader / matériau / VAO / profondeur, indice de
+     * commande). Les paquets de chaque Recorder sont triés par radix sort, en
+     * parallèle si un JobSystem est fourni, puis fusionnés ; execute() rejoue une passe
+     * sur le thread OpenGL à travers un StateCache et fusionne les plages d'indices
+     * contiguës en un seul draw. Avec une FrameArena, les paquets et commandes de
+     * chaque Recorder sont alloués dans la sous-arène de son thread.
+     */
+    class RenderQueue {
+    public:
+        struct Packet {
+            uint64_t key;
+            uint32_t payload;
+        };
+
+        class Recorder {
+        public:
+            explicit Recorder(std::pmr::memory_resource* resource);
+
+            void submit(uint64_t key, const RenderCommand& command);
+            // One command per submesh, keyed by its material
+            void submit(unsigned int pass, const Shader& shader, const Mesh& mesh, const glm::mat4& model,
+                        const glm::mat3& normalMatrix, float depth);
+            size_t size() const { return packets.size(); }
+
+        private:
+            friend class RenderQueue;
+
+            uint32_t index = 0;
+            std::pmr::vector<Packet> packets;
+            std::pmr::vector<Packet> scratch;
+            std::pmr::vector<RenderCommand> commands;
+        };
+
+        struct Stats {
+            size_t packets = 0;
+            size_t drawCalls = 0;
+            size_t programBinds = 0;
+            size_t materialChanges = 0;
+            size_t vaoBinds = 0;
+            size_t transformChanges = 0;
+            double sortMs = 0.0;
+        };
+
+        using ShaderSetup = std::function<void(const Shader&)>;
+        using MaterialSetup = std::function<void(const Shader&, const Material&)>;
+
+        static constexpr unsigned int MAX_PASSES = 16;
+
+        // depth is in [0, 1], front to back
+        static uint64_t makeKey(unsigned int pass, unsigned int shader, unsigned int material, unsigned int vao, float depth);
+
+        // Recorder i allocates from sub-arena i; recorders past the arena's threads use the heap
+        explicit RenderQueue(unsigned int recorderCount = 1, FrameArena* arena = nullptr);
+
+        void setRecorderCount(unsigned int count);
+        unsigned int getRecorderCount() const { return (unsigned int)recorders.size(); }
+        Recorder& getRecorder(unsigned int index) { return recorders[index]; }
+
+        // Storage of the previous frame is left to the arena, capacities are kept
+        void clear();
+        void sort(JobSystem* jobs = nullptr);
+        void execute(StateCache& state, unsigned int pass, const ShaderSetup& onShader, const MaterialSetup& onMaterial);
+
+        const Stats& getStats() const { return stats; }
+
+    private:
+        FrameArena* arena;
+        std::vector<Recorder> recorders;
+        std::pmr::vector<Packet> sorted;
+        std::pmr::vector<Packet> merged;
+        Stats stats;
+
+        std::pmr::memory_resource* getResource(unsigned int recorder) const;
+
+        const RenderCommand& getCommand(uint32_t payload) const;
+    };
+}
+
+#endif // GLENGINE_RENDER_QUEUE_HPP
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef GLENGINE_RENDER_THREAD_HPP
+#define GLENGINE_RENDER_THREAD_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace GLEngine {
+    /**
+     * @brief Thread qui possède le contexte OpenGL et dessine les images soumises par le thread principal.
+     *
+     * Le thread principal publie l'image N+1 (dans un TripleBuffer) pendant que ce thread
+     * dessine l'image N, puis l'annonce avec submit(), qui ne fait qu'incrémenter un compteur.
+     * Plusieurs images soumises pendant un dessin n'en font qu'une : la plus récente.
+     * Le mutex ne sert qu'à s'endormir : ce thread quand rien n'est soumis, le thread
+     * principal dans waitForPickup() s'il doit voir chaque image dessinée (rejeu).
+     */
+    class RenderThread {
+    public:
+        using Function = std::function<void()>;
+        using Acquire = std::function<bool()>;
+
+        RenderThread();
+        ~RenderThread();
+
+        RenderThread(const RenderThread&) = delete;
+        RenderThread& operator=(const RenderThread&) = delete;
+
+        // onStart and onStop run on the new thread around the frames (make the context current, release it);
+        // onAcquire takes the published frame, waitForPickup() returns only once it did; onFrame is skipped
+        // when it returns false (the frame was already taken)
+        void start(Function onStart, Acquire onAcquire, Function onFrame, Function onStop);
+        // Submitted frames are still drawn, then onStop runs and the thread is joined
+        void stop();
+        bool isRunning() const { return thread.joinable(); }
+
+        // Main thread, once the frame is published
+        void submit();
+        // Main thread: returns once every submitted frame was taken, the next publish then overwrites none
+        void waitForPickup();
+        // Main thread: returns once every submitted frame was drawn
+        void waitForIdle();
+
+        uint64_t getSubmittedCount() const { return submitted.load(std::memory_order_relaxed); }
+        uint64_t getCompletedCount() const { return completed.load(std::memory_order_acquire); }
+        // Main thread time spent in the last waitForPickup() or waitForIdle()
+        double getLastWaitMs() const { return lastWaitMs; }
+
+    private:
+        std::thread thread;
+        std::atomic<uint64_t> submitted;
+        std::atomic<uint64_t> started;
+        std::atomic<uint64_t> completed;
+        std::atomic<bool> stopping;
+        std::atomic<unsigned int> sleepers;
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        double lastWaitMs;
+
+        void loop(Function onStart, Acquire onAcquire, Function onFrame, Function onStop);
+        void notify();
+        void waitFor(const std::atomic<uint64_t>& counter);
+    };
+}
+
+#endif // GLENGINE_RENDER_THREAD_HPP
\ No newline at end of file
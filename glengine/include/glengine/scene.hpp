@@ -0,0 +1,57 @@
+#ifndef GLENGINE_SCENE_HPP
+#define GLENGINE_SCENE_HPP
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <glm/glm.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief Hiérarchie de transformations stockée dans des tableaux contigus.
+     *
+     * Un noeud est toujours créé après son parent, les tableaux restent donc
+     * triés parent avant enfant et update() les parcourt en une seule passe.
+     * Seuls les sous-arbres marqués sales sont recalculés.
+     */
+    class Scene {
+    public:
+        using NodeId = unsigned int;
+        static constexpr NodeId INVALID_NODE = std::numeric_limits<NodeId>::max();
+
+        Scene();
+
+        NodeId createNode(NodeId parent = INVALID_NODE, const glm::mat4& local = glm::mat4(1.0f));
+        void setLocalTransform(NodeId node, const glm::mat4& local);
+        void clear();
+
+        size_t update();
+
+        const glm::mat4& getLocalTransform(NodeId node) const { return localMatrices[node]; }
+        const glm::mat4& getWorldMatrix(NodeId node) const { return worldMatrices[node]; }
+        const glm::mat3& getNormalMatrix(NodeId node) const { return normalMatrices[node]; }
+        NodeId getParent(NodeId node) const { return parents[node]; }
+
+        const std::vector<glm::mat4>& getWorldMatrices() const { return worldMatrices; }
+        const std::vector<glm::mat3>& getNormalMatrices() const { return normalMatrices; }
+
+        size_t size() const { return parents.size(); }
+        size_t getLastUpdateCount() const { return lastUpdateCount; }
+        uint64_t getRevision() const { return revision; }
+
+    private:
+        std::vector<NodeId> parents;
+        std::vector<glm::mat4> localMatrices;
+        std::vector<glm::mat4> worldMatrices;
+        std::vector<glm::mat3> normalMatrices;
+        std::vector<uint8_t> dirty;
+
+        NodeId firstDirty;
+        size_t lastUpdateCount;
+        uint64_t revision;
+
+        void markDirty(NodeId node);
+    };
+}
+
+#endif // GLENGINE_SCENE_HPP
\ No newline at end of file
@@ -0,0 +1,140 @@
+#ifndef GLENGINE_SESSION_HPP
+#define GLENGINE_SESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <glengine/orbitalCamera.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief Enregistrement et rejeu d'une session interactive.
+     *
+     * Le fichier binaire contient la taille du framebuffer, les paramètres liés
+     * par nom, puis un flux d'événements : horloge de chaque image, entrées de la
+     * caméra et valeurs de paramètres modifiées (comparées octet par octet en fin
+     * d'image). Au rejeu les paramètres sont associés par nom, deux versions du
+     * programme rejouent donc les mêmes images et leurs temps peuvent être comparés.
+     */
+    class Session {
+    public:
+        enum class Mode {
+            IDLE,
+            RECORDING,
+            REPLAYING
+        };
+
+        enum class CameraInput : uint8_t {
+            ORBIT,
+            TRACK,
+            PEDESTAL,
+            DOLLY,
+            ZOOM
+        };
+
+        struct FrameTiming {
+            double time;
+            double cpuMs;
+            double gpuMs;
+        };
+
+        Session();
+        ~Session();
+
+        // onReplay repeats the side effects the UI runs when it changes the value
+        template<typename T>
+        void bind(const std::string& name, T& value, std::function<void()> onReplay = nullptr) {
+            static_assert(std::is_trivially_copyable<T>::value, "session parameters are copied as raw bytes");
+            T* pointer = &value;
+            addParameter(name, sizeof(T),
+                [pointer](void* out) { std::memcpy(out, pointer, sizeof(T)); },
+                [pointer, onReplay](const void* in) {
+                    std::memcpy(pointer, in, sizeof(T));
+                    if (onReplay) {
+                        onReplay();
+                    }
+                });
+        }
+
+        // For state kept inside engine objects behind getters and setters
+        template<typename T>
+        void bindProperty(const std::string& name, std::function<T()> get, std::function<void(const T&)> set) {
+            static_assert(std::is_trivially_copyable<T>::value, "session parameters are copied as raw bytes");
+            addParameter(name, sizeof(T),
+                [get](void* out) { T value = get(); std::memcpy(out, &value, sizeof(T)); },
+                [set](const void* in) { T value; std::memcpy(&value, in, sizeof(T)); set(value); });
+        }
+
+        bool startRecording(const std::string& path, const OrbitalCamera& camera, int width, int height);
+        bool startReplay(const std::string& path);
+        void stop();
+
+        // Forwarded to the camera and recorded; ignored while replaying
+        void cameraInput(OrbitalCamera& camera, CameraInput input, float x, float y = 0.0f);
+
+        // Replay overwrites time with the recorded clock and returns false after the last frame
+        bool beginFrame(OrbitalCamera& camera, double& time);
+        void endFrame(double cpuMs, double gpuMs);
+
+        bool writeTimings(const std::string& path) const;
+        void printSummary(std::ostream& out) const;
+        // JSON object with the frame count and CPU / GPU mean and percentiles
+        void writeSummaryJson(std::ostream& out) const;
+
+        Mode getMode() const { return mode; }
+        bool isRecording() const { return mode == Mode::RECORDING; }
+        bool isReplaying() const { return mode == Mode::REPLAYING; }
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+        uint64_t getFrameCount() const { return frameCount; }
+        uint64_t getBytesWritten() const { return bytesWritten; }
+        // Parameter values replayed or recorded so far, frames that change none are steady
+        uint64_t getParameterChangeCount() const { return parameterChanges; }
+        const std::vector<FrameTiming>& getTimings() const { return timings; }
+
+    private:
+        struct Parameter {
+            std::string name;
+            size_t size;
+            std::function<void(void*)> read;
+            std::function<void(const void*)> write;
+            std::vector<unsigned char> recorded;
+        };
+
+        // Replayed parameters, matched by name and size to the bound ones
+        struct FileParameter {
+            int bound;
+            size_t size;
+        };
+
+        Mode mode;
+        std::ofstream output;
+        std::ifstream input;
+        std::vector<Parameter> parameters;
+        std::vector<FileParameter> fileParameters;
+        std::vector<unsigned char> scratch;
+        std::vector<FrameTiming> timings;
+        int width;
+        int height;
+        uint64_t frameCount;
+        uint64_t bytesWritten;
+        uint64_t parameterChanges;
+        double frameTime;
+
+        void addParameter(const std::string& name, size_t size, std::function<void(void*)> read,
+                          std::function<void(const void*)> write);
+        void writeBytes(const void* data, size_t size);
+        bool readBytes(void* data, size_t size);
+        void writeParameter(uint16_t index);
+        void writeChangedParameters(bool all);
+        void getSummary(std::vector<double>& cpu, std::vector<double>& gpu, double& cpuMean, double& gpuMean) const;
+    };
+}
+
+#endif // GLENGINE_SESSION_HPP
\ No newline at end of file
@@ -13,11 +13,17 @@ namespace GLEngine {
         ~Shader();
 
         void use() const;
-        void setBool(const std::string &name, bool value) const;
-        void setInt(const std::string &name, int value) const;
-        void setFloat(const std::string &name, float value) const;
-        void setVec3(const std::string &name, const glm::vec3 &value) const;
-        void setMat4(const std::string &name, const glm::mat4 &mat) const;
+        void setBool(const char* name, bool value) const;
+        void setInt(const char* name, int value) const;
+        void setFloat(const char* name, float value) const;
+        void setVec2(const char* name, const glm::vec2 &value) const;
+        void setIVec3(const char* name, const glm::ivec3 &value) const;
+        void setVec3(const char* name, const glm::vec3 &value) const;
+        void setVec4(const char* name, const glm::vec4 &value) const;
+        void setMat3(const char* name, const glm::mat3 &mat) const;
+        void setMat4(const char* name, const glm::mat4 &mat) const;
+        // Ignored when the program has no such block
+        void bindUniformBlock(const char* name, unsigned int binding) const;
 
         unsigned int getId() const { return id; }
 
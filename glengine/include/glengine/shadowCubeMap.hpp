@@ -0,0 +1,51 @@
+#ifndef GLENGINE_SHADOW_CUBE_MAP_HPP
+#define GLENGINE_SHADOW_CUBE_MAP_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <glm/glm.hpp>
+#include <glengine/gpuMemory.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief Shadow map omnidirectionnelle (cube map de profondeur) mise en cache.
+     *
+     * Les six faces ne sont re-rendues que lorsque la révision fournie change
+     * (position de la lumière, maillage ou transformations) ; en scène statique
+     * l'ombre ne coûte qu'une lecture samplerCubeShadow (PCF 2x2 matériel).
+     */
+    class ShadowCubeMap {
+    public:
+        ShadowCubeMap(int size = 1024, float nearPlane = 0.05f, float farPlane = 50.0f);
+        ~ShadowCubeMap();
+
+        bool needsUpdate(uint64_t revision) const;
+        void render(const glm::vec3& lightPos, uint64_t revision,
+                    const std::function<void(const glm::mat4& lightViewProjection)>& drawScene);
+        void invalidate() { valid = false; }
+
+        void bind(int textureUnit) const;
+        void cleanup();
+
+        void setSize(int size);
+        int getSize() const { return size; }
+        float getNearPlane() const { return nearPlane; }
+        float getFarPlane() const { return farPlane; }
+        uint64_t getRenderCount() const { return renderCount; }
+        size_t getMemorySize() const { return texture ? (size_t)size * size * 6 * 4 : 0; }
+
+    private:
+        unsigned int FBO, texture;
+        GpuMemory::Handle memoryHandle;
+        int size;
+        float nearPlane, farPlane;
+        bool valid;
+        uint64_t renderedRevision;
+        uint64_t renderCount;
+
+        void setup();
+    };
+}
+
+#endif // GLENGINE_SHADOW_CUBE_MAP_HPP
\ No newline at end of file
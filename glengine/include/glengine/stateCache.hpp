@@ -0,0 +1,32 @@
+#ifndef GLENGINE_STATE_CACHE_HPP
+#define GLENGINE_STATE_CACHE_HPP
+
+#include <cstdint>
+
+namespace GLEngine {
+    /**
+     * @brief Copie côté CPU de l'état OpenGL lié, pour filtrer les appels redondants.
+     *
+     * Seuls les changements passent au driver. Tout code qui modifie l'état sans
+     * passer par le cache doit appeler invalidate() avant de le réutiliser.
+     */
+    class StateCache {
+    public:
+        StateCache();
+
+        bool useProgram(unsigned int program);
+        bool bindVertexArray(unsigned int vao);
+        void invalidate();
+
+        uint64_t getIssuedCount() const { return issued; }
+        uint64_t getSkippedCount() const { return skipped; }
+
+    private:
+        unsigned int program;
+        unsigned int vao;
+        uint64_t issued;
+        uint64_t skipped;
+    };
+}
+
+#endif // GLENGINE_STATE_CACHE_HPP
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef GLENGINE_STREAM_BUFFER_HPP
+#define GLENGINE_STREAM_BUFFER_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glengine/gpuMemory.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief Anneau de données dynamiques envoyées au GPU à chaque image.
+     *
+     * Le buffer est découpé en régions, une par image en vol, chacune protégée par
+     * une fence posée en fin d'image : une région n'est réécrite qu'une fois le GPU
+     * passé, ce qui permet d'écrire sans synchronisation implicite du driver. Avec
+     * ARB_buffer_storage le buffer reste mappé en permanence, sinon chaque écriture
+     * passe par glMapBufferRange(GL_MAP_UNSYNCHRONIZED_BIT).
+     */
+    class StreamBuffer {
+    public:
+        static constexpr size_t INVALID_OFFSET = ~size_t(0);
+
+        struct Stats {
+            size_t bytesLastFrame = 0;
+            uint64_t bytesStreamed = 0;
+            uint64_t allocations = 0;
+            uint64_t overflows = 0;
+            uint64_t mapFailures = 0;
+            uint64_t fenceWaits = 0;
+            double lastWaitMs = 0.0;
+            double totalWaitMs = 0.0;
+        };
+
+        // glBufferStorage is not part of the generated GL 3.3 loader
+        static bool loadExtensions(GLADloadproc load);
+        static bool isPersistentMappingSupported();
+
+        StreamBuffer(size_t regionSize = 1u << 20, unsigned int regionCount = 3);
+        ~StreamBuffer();
+
+        void beginFrame();
+        // nullptr and INVALID_OFFSET when the region is full or the map failed, nothing is reserved then
+        void* map(size_t size, size_t alignment, size_t& offset);
+        void unmap();
+        size_t write(const void* data, size_t size, size_t alignment = 16);
+        void endFrame();
+        void cleanup();
+
+        void setPersistentMapping(bool enabled);
+        bool getPersistentMapping() const { return persistentRequested; }
+        bool isPersistent() const { return persistentData != nullptr; }
+
+        unsigned int getBuffer() const { return buffer; }
+        // Bumped on every reallocation; the GL name alone may be reused by the new buffer
+        uint64_t getGeneration() const { return generation; }
+        size_t getRegionSize() const { return regionSize; }
+        unsigned int getRegionCount() const { return (unsigned int)fences.size(); }
+        const Stats& getStats() const { return stats; }
+
+    private:
+        unsigned int buffer;
+        uint64_t generation;
+        size_t regionSize;
+        size_t pendingRegionSize;
+        std::vector<GLsync> fences;
+        unsigned int region;
+        size_t head;
+        size_t regionEnd;
+        size_t frameBytes;
+        size_t frameDemand;
+        bool persistentRequested;
+        bool recreate;
+        unsigned char* persistentData;
+        bool mapped;
+        GpuMemory::Handle memoryHandle;
+        Stats stats;
+
+        void create();
+        void destroy();
+    };
+}
+
+#endif // GLENGINE_STREAM_BUFFER_HPP
\ No newline at end of file
@@ -0,0 +1,120 @@
+#ifndef GLENGINE_TEXTURE_CACHE_HPP
+#define GLENGINE_TEXTURE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glengine/gpuMemory.hpp>
+#include <glengine/threadPool.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief Cache de textures indexé par chemin, chargé en arrière-plan.
+     *
+     * Le décodage (stb_image) et la génération des mipmaps (stb_image_resize2) sont
+     * faits sur un petit pool de threads dédié ; deux fichiers au contenu identique partagent
+     * la même texture. L'envoi au GPU est limité à un budget d'octets par image, du
+     * plus petit niveau de mipmap au plus grand, la texture est donc utilisable en
+     * basse résolution avant la fin du transfert. Au-delà du budget mémoire GPU, les
+     * textures les moins récemment utilisées sont libérées.
+     */
+    class TextureCache {
+    public:
+        using Handle = uint32_t;
+        static constexpr Handle INVALID_HANDLE = 0xFFFFFFFFu;
+
+        // Two decode threads by default, see workers
+        TextureCache(size_t gpuBudget = 512u << 20, size_t uploadBudget = 16u << 20, unsigned int threadCount = 2);
+        ~TextureCache();
+
+        Handle load(const std::string& path);
+        void bind(Handle handle, int textureUnit);
+        bool isReady(Handle handle) const;
+        void update();
+        void cleanup();
+
+        void setGpuBudget(size_t budget) { gpuBudget = budget; }
+        size_t getGpuBudget() const { return gpuBudget; }
+        void setUploadBudget(size_t budget) { uploadBudget = budget; }
+        size_t getUploadBudget() const { return uploadBudget; }
+
+        size_t getTextureCount() const { return entries.size(); }
+        size_t getResidentCount() const;
+        size_t getPendingCount() const;
+        size_t getGpuMemory() const { return gpuMemory; }
+        size_t getUploadedLastFrame() const { return uploadedLastFrame; }
+        uint64_t getDecodeCount() const { return decodeCount; }
+        uint64_t getDedupCount() const { return dedupCount; }
+        uint64_t getEvictionCount() const { return evictionCount; }
+
+    private:
+        enum class State {
+            QUEUED,
+            UPLOADING,
+            RESIDENT,
+            EVICTED,
+            FAILED
+        };
+
+        struct MipLevel {
+            int width, height;
+            std::vector<unsigned char> pixels;
+        };
+
+        // Produced by the workers, consumed on the GL thread
+        struct Decoded {
+            Handle handle;
+            Handle alias;
+            std::vector<MipLevel> levels;
+        };
+
+        struct Entry {
+            std::string path;
+            State state;
+            Handle alias;
+            unsigned int texture;
+            size_t memory;
+            GpuMemory::Handle memoryHandle;
+            uint64_t lastUsed;
+            std::unique_ptr<Decoded> decoded;
+            int nextLevel;
+        };
+
+        std::vector<Entry> entries;
+        std::unordered_map<std::string, Handle> handlesByPath;
+        std::deque<Handle> uploadQueue;
+        unsigned int fallbackTexture;
+        GpuMemory::Handle fallbackMemoryHandle;
+
+        size_t gpuBudget;
+        size_t uploadBudget;
+        size_t gpuMemory;
+        size_t uploadedLastFrame;
+        uint64_t frameIndex;
+        uint64_t decodeCount;
+        uint64_t dedupCount;
+        uint64_t evictionCount;
+
+        // Shared with the workers
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, Handle> ownersByHash;
+        std::vector<std::unique_ptr<Decoded>> completed;
+
+        // Not the JobSystem: a decode reads a file and runs for milliseconds, a frame waiting on its
+        // counter could pick one up. Kept small so it does not compete with the JobSystem workers
+        ThreadPool workers;
+
+        Handle resolve(Handle handle) const;
+        void request(Handle handle);
+        void decode(Handle handle, const std::string& path);
+        void uploadLevel(Entry& entry);
+        void evict();
+    };
+}
+
+#endif // GLENGINE_TEXTURE_CACHE_HPP
\ No newline at end of file
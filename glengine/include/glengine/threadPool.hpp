@@ -0,0 +1,49 @@
+#ifndef GLENGINE_THREAD_POOL_HPP
+#define GLENGINE_THREAD_POOL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GLEngine {
+    /**
+     * @brief Pool de threads minimal pour les tâches hors contexte OpenGL.
+     *
+     * Les tâches sont exécutées dans l'ordre de soumission ; elles ne doivent
+     * jamais appeler OpenGL, le contexte n'appartient qu'au thread de rendu.
+     */
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned int threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(std::function<void()> task);
+        void wait();
+        bool waitForPendingBelow(size_t count, std::chrono::microseconds timeout);
+        void shutdown();
+
+        size_t getThreadCount() const { return threads.size(); }
+        size_t getPendingCount() const;
+
+    private:
+        std::vector<std::thread> threads;
+        std::deque<std::function<void()>> tasks;
+        mutable std::mutex mutex;
+        std::condition_variable taskAvailable;
+        std::condition_variable idle;
+        size_t running;
+        bool stopping;
+
+        void workerLoop();
+    };
+}
+
+#endif // GLENGINE_THREAD_POOL_HPP
\ No newline at end of file
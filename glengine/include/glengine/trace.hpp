@@ -0,0 +1,116 @@
+#ifndef GLENGINE_TRACE_HPP
+#define GLENGINE_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define GLENGINE_TRACE_TSC
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define GLENGINE_TRACE_TSC
+#endif
+
+namespace GLEngine {
+    /**
+     * @brief Zones de trace CPU exportées au format Chrome trace (chrome://tracing, Perfetto).
+     *
+     * Chaque thread écrit ses zones dans son propre anneau, sans verrou ; seul
+     * l'enregistrement du thread, à sa première zone, prend un mutex. L'anneau
+     * garde les derniers événements. Les zones n'existent que si glengine est
+     * compilé avec l'option CMake GLENGINE_TRACE, sinon les macros sont vides.
+     * Sur x86 les zones lisent le compteur TSC, converti en temps à l'export.
+     */
+    class Trace {
+    public:
+        struct Event {
+            const char* name;
+            uint64_t start;
+            uint64_t end;
+        };
+
+        static constexpr size_t RING_SIZE = 1u << 16;
+
+        struct ThreadBuffer {
+            std::atomic<uint64_t> head{0};
+            uint32_t id = 0;
+            std::string name;
+            Event events[RING_SIZE];
+        };
+
+        // Names must outlive the export, string literals in practice
+        class Zone {
+        public:
+            explicit Zone(const char* name) : name(name), parent(currentZone), start(now()) { currentZone = name; }
+            ~Zone() {
+                record(name, start, now());
+                currentZone = parent;
+            }
+
+            Zone(const Zone&) = delete;
+            Zone& operator=(const Zone&) = delete;
+
+        private:
+            const char* name;
+            const char* parent;
+            uint64_t start;
+        };
+
+        // Ticks: TSC where available (a steady_clock read costs tens of ns in VMs), steady_clock ns otherwise
+        static uint64_t now() {
+#ifdef GLENGINE_TRACE_TSC
+            return __rdtsc();
+#else
+            return steadyNanoseconds();
+#endif
+        }
+
+        static uint64_t steadyNanoseconds() {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static void record(const char* name, uint64_t startTicks, uint64_t endTicks) {
+            ThreadBuffer* buffer = threadBuffer ? threadBuffer : registerThread();
+            uint64_t index = buffer->head.load(std::memory_order_relaxed);
+            buffer->events[index & (RING_SIZE - 1)] = { name, startTicks, endTicks };
+            buffer->head.store(index + 1, std::memory_order_release);
+        }
+
+        // Spans measured elsewhere in steady_clock nanoseconds (job trace hooks)
+        static void recordNanoseconds(const char* name, uint64_t startNs, uint64_t endNs) {
+            record(name, startNs | NANOSECONDS_FLAG, endNs);
+        }
+
+        // Innermost open zone of the calling thread, nullptr outside zones or without GLENGINE_TRACE
+        static const char* getCurrentZone() { return currentZone; }
+
+        static void setThreadName(const std::string& name);
+        // Safe while other threads keep tracing, events overwritten during the copy are dropped
+        static bool write(const std::string& path);
+        static uint64_t getEventCount();
+
+    private:
+        static constexpr uint64_t NANOSECONDS_FLAG = 1ull << 63;
+
+        static thread_local ThreadBuffer* threadBuffer;
+        static thread_local const char* currentZone;
+
+        static ThreadBuffer* registerThread();
+    };
+}
+
+#ifdef GLENGINE_TRACE
+#define GLENGINE_TRACE_CONCAT_IMPL(a, b) a##b
+#define GLENGINE_TRACE_CONCAT(a, b) GLENGINE_TRACE_CONCAT_IMPL(a, b)
+#define GLENGINE_TRACE_ZONE(name) ::GLEngine::Trace::Zone GLENGINE_TRACE_CONCAT(traceZone, __LINE__)(name)
+#define GLENGINE_TRACE_THREAD(name) ::GLEngine::Trace::setThreadName(name)
+#else
+#define GLENGINE_TRACE_ZONE(name) ((void)0)
+#define GLENGINE_TRACE_THREAD(name) ((void)0)
+#endif
+
+#endif // GLENGINE_TRACE_HPP
\ No newline at end of file
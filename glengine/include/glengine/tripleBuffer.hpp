@@ -0,0 +1,69 @@
+#ifndef GLENGINE_TRIPLE_BUFFER_HPP
+#define GLENGINE_TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace GLEngine {
+    /**
+     * @brief Échange sans verrou de la dernière valeur entre un producteur et un consommateur.
+     *
+     * Trois emplacements : celui que le producteur écrit, celui que le consommateur lit,
+     * et le dernier publié. publish() et update() échangent leur emplacement avec le
+     * publié par une seule opération atomique, aucun des deux threads n'attend l'autre.
+     * Une valeur publiée deux fois avant d'être lue est remplacée par la plus récente.
+     */
+    template<typename T>
+    class TripleBuffer {
+    public:
+        TripleBuffer() : middle(1), writeIndex(0), dropped(0), readIndex(2) {}
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        // Producer: the slot to fill, it holds whatever was written there two publishes ago
+        T& getWriteBuffer() { return slots[writeIndex].value; }
+
+        // Producer: hands the written slot over and takes back the published one
+        void publish() {
+            uint8_t previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+            if (previous & FRESH) {
+                dropped++;
+            }
+            writeIndex = previous & INDEX;
+        }
+
+        // Consumer: takes the latest published value, false when nothing new was published
+        bool update() {
+            if (!(middle.load(std::memory_order_relaxed) & FRESH)) {
+                return false;
+            }
+            uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & INDEX;
+            return true;
+        }
+
+        // Consumer: stays valid and unchanged until the next update()
+        const T& getReadBuffer() const { return slots[readIndex].value; }
+
+        // Producer: values overwritten before the consumer saw them
+        uint64_t getDroppedCount() const { return dropped; }
+
+    private:
+        static constexpr uint8_t INDEX = 3;
+        static constexpr uint8_t FRESH = 4;
+
+        // One cache line each, the two threads write different slots
+        struct alignas(64) Slot {
+            T value;
+        };
+
+        Slot slots[3];
+        alignas(64) std::atomic<uint8_t> middle;
+        alignas(64) uint8_t writeIndex;
+        uint64_t dropped;
+        alignas(64) uint8_t readIndex;
+    };
+}
+
+#endif // GLENGINE_TRIPLE_BUFFER_HPP
\ No newline at end of file
@@ -12,6 +12,9 @@ namespace GLEngine {
     std::string readFile(const char* filePath);
     
     void loadObjFile(const char* filePath, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, bool& hasTexCoords);
+    void loadObjFile(const char* filePath, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+                     std::vector<SubMesh>& subMeshes, std::vector<Material>& materials, bool& hasTexCoords);
+    void loadMtlFile(const char* filePath, std::vector<Material>& materials);
                      
     void computeNormals(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
     
@@ -0,0 +1,94 @@
+#ifndef GLENGINE_VIDEO_STREAM_HPP
+#define GLENGINE_VIDEO_STREAM_HPP
+
+#include <glad/glad.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <glengine/gpuMemory.hpp>
+#include <glengine/threadPool.hpp>
+
+namespace GLEngine {
+    /**
+     * @brief Flux vidéo brut YUV4MPEG2 (y4m) vers stdout ou un tube nommé.
+     *
+     * La relecture passe par deux pixel pack buffers protégés par des fences ; la
+     * conversion RGB vers YUV 4:2:0 (vectorisée en SSE2) et l'écriture sont faites
+     * par un thread dédié. Si l'encodeur en aval ne suit pas, la boucle de rendu
+     * n'attend jamais plus d'une image avant d'abandonner l'image courante. La sortie
+     * est ouverte et écrite sans blocage : un tube sans lecteur n'empêche pas stop().
+     */
+    class VideoStream {
+    public:
+        VideoStream(int fps = 60, int maxQueuedFrames = 3);
+        ~VideoStream();
+
+        bool start(const std::string& path, int width, int height);
+        void stop();
+        bool isStreaming() const { return streaming; }
+
+        void capture(int width, int height, unsigned int framebuffer = 0);
+        void cleanup();
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+        int getFps() const { return fps; }
+        bool hasError() const { return error.load(); }
+        uint64_t getFramesWritten() const { return framesWritten.load(); }
+        uint64_t getFramesDropped() const { return framesDropped; }
+        uint64_t getBytesWritten() const { return bytesWritten.load(); }
+        float getConvertTime() const { return convertTimeMs.load(); }
+        // Both measured from start() to now, or to stop() once stopped
+        double getThroughput() const;
+        double getElapsedTime() const;
+
+        // Lignes RGBA de bas en haut (convention OpenGL), plans YUV de haut en bas
+        static void convertToYUV420(const unsigned char* rgba, int width, int height,
+                                    unsigned char* y, unsigned char* u, unsigned char* v);
+
+    private:
+        struct Slot {
+            unsigned int pbo;
+            GLsync fence;
+        };
+
+        int fps;
+        int maxQueuedFrames;
+        bool streaming;
+        std::string path;
+        int width, height;
+
+        std::array<Slot, 2> slots;
+        int next;
+        GpuMemory::Handle memoryHandle;
+
+        // File descriptor, -1 until the writer thread opened it
+        int output;
+        int outputFlags;
+        std::vector<unsigned char> yuv;
+        std::atomic<bool> error;
+        std::atomic<bool> cancelled;
+        std::atomic<uint64_t> framesWritten;
+        uint64_t framesDropped;
+        std::atomic<uint64_t> bytesWritten;
+        std::atomic<float> convertTimeMs;
+        std::chrono::steady_clock::time_point startTime;
+        std::chrono::steady_clock::time_point stopTime;
+
+        ThreadPool writer;
+        std::mutex bufferMutex;
+        std::vector<std::vector<unsigned char>> freeBuffers;
+
+        bool handOff(Slot& slot, std::chrono::steady_clock::time_point deadline);
+        void write(std::vector<unsigned char> pixels);
+        bool openOutput();
+        bool writeOutput(const void* data, size_t size);
+        void closeOutput();
+    };
+}
+
+#endif // GLENGINE_VIDEO_STREAM_HPP
\ No newline at end of file
@@ -0,0 +1,356 @@
+#include <glengine/allocStats.hpp>
+#include <glengine/trace.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+namespace GLEngine {
+    namespace {
+        // Cumulative counts, written by the owning thread and read by endFrame
+        struct ZoneSlot {
+            std::atomic<const char*> zone{nullptr};
+            std::atomic<uint64_t> allocations{0};
+            std::atomic<uint64_t> bytes{0};
+        };
+
+        struct ThreadSlot {
+            std::atomic<const char*> name{nullptr};
+            std::atomic<uint64_t> allocations{0};
+            std::atomic<uint64_t> frees{0};
+            std::atomic<uint64_t> bytes{0};
+            // Outside zones, or past MAX_ZONES
+            std::atomic<uint64_t> unzonedAllocations{0};
+            std::atomic<uint64_t> unzonedBytes{0};
+            ZoneSlot zones[AllocStats::MAX_ZONES];
+        };
+
+        struct ThreadSnapshot {
+            AllocStats::Counters counters;
+            uint64_t unzonedAllocations = 0;
+            uint64_t unzonedBytes = 0;
+            uint64_t zoneAllocations[AllocStats::MAX_ZONES] = {};
+            uint64_t zoneBytes[AllocStats::MAX_ZONES] = {};
+        };
+
+        // Static storage only: the hooks run before main and must never allocate themselves
+        ThreadSlot threadSlots[AllocStats::MAX_THREADS];
+        std::atomic<size_t> threadCount{0};
+        thread_local ThreadSlot* threadSlot = nullptr;
+        thread_local int excludeDepth = 0;
+
+        // endFrame state, main loop thread only
+        ThreadSnapshot previous[AllocStats::MAX_THREADS];
+        AllocStats::Counters frame;
+        AllocStats::Counters maximum;
+        AllocStats::Counters total;
+        uint64_t frameCount = 0;
+        std::vector<AllocStats::ThreadCounters> frameThreads;
+        std::vector<AllocStats::ZoneCounters> frameZones;
+
+        ThreadSlot& getThreadSlot() {
+            if (threadSlot == nullptr) {
+                size_t index = threadCount.fetch_add(1, std::memory_order_relaxed);
+                if (index >= AllocStats::MAX_THREADS - 1) {
+                    index = AllocStats::MAX_THREADS - 1;
+                    threadSlots[index].name.store("Other threads", std::memory_order_relaxed);
+                }
+                threadSlot = &threadSlots[index];
+            }
+            return *threadSlot;
+        }
+
+        // Open addressing on the name pointer, claimed with a CAS since the overflow slot is shared
+        ZoneSlot* findZone(ThreadSlot& slot, const char* zone) {
+            size_t start = ((uintptr_t)zone >> 3) % AllocStats::MAX_ZONES;
+            for (size_t i = 0; i < AllocStats::MAX_ZONES; i++) {
+                ZoneSlot& candidate = slot.zones[(start + i) % AllocStats::MAX_ZONES];
+                const char* key = candidate.zone.load(std::memory_order_acquire);
+                if (key == zone) {
+                    return &candidate;
+                }
+                if (key == nullptr) {
+                    if (candidate.zone.compare_exchange_strong(key, zone, std::memory_order_acq_rel) || key == zone) {
+                        return &candidate;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        void addZone(const char* zone, uint64_t allocations, uint64_t bytes) {
+            auto it = std::find_if(frameZones.begin(), frameZones.end(), [zone](const AllocStats::ZoneCounters& entry) {
+                return entry.zone == zone;
+            });
+            if (it == frameZones.end()) {
+                // Capacity is reserved, the last entry gathers what does not fit and loses its name
+                if (frameZones.size() == frameZones.capacity()) {
+                    it = frameZones.end() - 1;
+                    it->zone = nullptr;
+                } else {
+                    frameZones.push_back({ zone, AllocStats::Counters() });
+                    it = frameZones.end() - 1;
+                }
+            }
+            it->counters.allocations += allocations;
+            it->counters.bytes += bytes;
+        }
+
+        template<typename Function>
+        void forEachCounter(AllocStats::Counters& a, const AllocStats::Counters& b, Function function) {
+            function(a.allocations, b.allocations);
+            function(a.frees, b.frees);
+            function(a.bytes, b.bytes);
+        }
+    }
+
+    AllocStats::Exclude::Exclude() {
+        excludeDepth++;
+    }
+
+    AllocStats::Exclude::~Exclude() {
+        excludeDepth--;
+    }
+
+    bool AllocStats::isEnabled() {
+#ifdef GLENGINE_ALLOC_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void AllocStats::setThreadName(const char* name) {
+        getThreadSlot().name.store(name, std::memory_order_relaxed);
+    }
+
+    void AllocStats::onAllocate(size_t bytes) {
+        if (excludeDepth > 0) {
+            return;
+        }
+        ThreadSlot& slot = getThreadSlot();
+        slot.allocations.fetch_add(1, std::memory_order_relaxed);
+        slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+        const char* zone = Trace::getCurrentZone();
+        ZoneSlot* zoneSlot = zone ? findZone(slot, zone) : nullptr;
+        if (zoneSlot) {
+            zoneSlot->allocations.fetch_add(1, std::memory_order_relaxed);
+            zoneSlot->bytes.fetch_add(bytes, std::memory_order_relaxed);
+        } else {
+            slot.unzonedAllocations.fetch_add(1, std::memory_order_relaxed);
+            slot.unzonedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+    }
+
+    void AllocStats::onFree() {
+        if (excludeDepth > 0) {
+            return;
+        }
+        getThreadSlot().frees.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void AllocStats::endFrame() {
+        if (!isEnabled()) {
+            return;
+        }
+        if (frameThreads.capacity() == 0) {
+            Exclude exclude;
+            frameThreads.reserve(MAX_THREADS);
+            frameZones.reserve(MAX_ZONES + 1);
+        }
+
+        frame = Counters();
+        frameThreads.clear();
+        frameZones.clear();
+        size_t count = std::min(threadCount.load(std::memory_order_relaxed), MAX_THREADS);
+        for (size_t i = 0; i < count; i++) {
+            ThreadSlot& slot = threadSlots[i];
+            ThreadSnapshot& snapshot = previous[i];
+
+            Counters current;
+            current.allocations = slot.allocations.load(std::memory_order_relaxed);
+            current.frees = slot.frees.load(std::memory_order_relaxed);
+            current.bytes = slot.bytes.load(std::memory_order_relaxed);
+            Counters delta;
+            forEachCounter(delta, current, [](uint64_t& a, uint64_t b) { a = b; });
+            forEachCounter(delta, snapshot.counters, [](uint64_t& a, uint64_t b) { a -= b; });
+            snapshot.counters = current;
+            if (delta.allocations == 0 && delta.frees == 0) {
+                continue;
+            }
+            const char* name = slot.name.load(std::memory_order_relaxed);
+            frameThreads.push_back({ name ? name : "Unnamed thread", delta });
+            forEachCounter(frame, delta, [](uint64_t& a, uint64_t b) { a += b; });
+
+            for (size_t z = 0; z < MAX_ZONES; z++) {
+                const char* zone = slot.zones[z].zone.load(std::memory_order_acquire);
+                if (zone == nullptr) {
+                    continue;
+                }
+                uint64_t allocations = slot.zones[z].allocations.load(std::memory_order_relaxed);
+                uint64_t bytes = slot.zones[z].bytes.load(std::memory_order_relaxed);
+                if (allocations != snapshot.zoneAllocations[z]) {
+                    addZone(zone, allocations - snapshot.zoneAllocations[z], bytes - snapshot.zoneBytes[z]);
+                }
+                snapshot.zoneAllocations[z] = allocations;
+                snapshot.zoneBytes[z] = bytes;
+            }
+            uint64_t unzonedAllocations = slot.unzonedAllocations.load(std::memory_order_relaxed);
+            uint64_t unzonedBytes = slot.unzonedBytes.load(std::memory_order_relaxed);
+            if (unzonedAllocations != snapshot.unzonedAllocations) {
+                addZone(nullptr, unzonedAllocations - snapshot.unzonedAllocations, unzonedBytes - snapshot.unzonedBytes);
+            }
+            snapshot.unzonedAllocations = unzonedAllocations;
+            snapshot.unzonedBytes = unzonedBytes;
+        }
+
+        std::sort(frameThreads.begin(), frameThreads.end(), [](const ThreadCounters& a, const ThreadCounters& b) {
+            return a.counters.bytes > b.counters.bytes;
+        });
+        std::sort(frameZones.begin(), frameZones.end(), [](const ZoneCounters& a, const ZoneCounters& b) {
+            return a.counters.bytes > b.counters.bytes;
+        });
+        forEachCounter(maximum, frame, [](uint64_t& a, uint64_t b) { a = std::max(a, b); });
+        forEachCounter(total, frame, [](uint64_t& a, uint64_t b) { a += b; });
+        frameCount++;
+    }
+
+    const AllocStats::Counters& AllocStats::getFrame() {
+        return frame;
+    }
+
+    const AllocStats::Counters& AllocStats::getMax() {
+        return maximum;
+    }
+
+    const AllocStats::Counters& AllocStats::getTotal() {
+        return total;
+    }
+
+    uint64_t AllocStats::getFrameCount() {
+        return frameCount;
+    }
+
+    const std::vector<AllocStats::ThreadCounters>& AllocStats::getFrameThreads() {
+        return frameThreads;
+    }
+
+    const std::vector<AllocStats::ZoneCounters>& AllocStats::getFrameZones() {
+        return frameZones;
+    }
+
+    void AllocStats::writeJson(std::ostream& out) {
+        double frames = std::max<double>((double)frameCount, 1.0);
+        auto counter = [&](const char* name, uint64_t sum, uint64_t max) {
+            out << ",\"" << name << "\":{\"mean\":" << (double)sum / frames << ",\"max\":" << max << "}";
+        };
+
+        out << std::fixed << std::setprecision(3) << "{\"enabled\":" << (isEnabled() ? "true" : "false")
+            << ",\"frames\":" << frameCount;
+        counter("allocations", total.allocations, maximum.allocations);
+        counter("frees", total.frees, maximum.frees);
+        counter("bytes", total.bytes, maximum.bytes);
+        out << "}";
+    }
+}
+
+#ifdef GLENGINE_ALLOC_STATS
+// Replaces the global allocation functions of the whole program; the size of a
+// freed block is unknown to the unsized forms, so only the allocated bytes are counted
+namespace {
+    void* allocate(std::size_t size) {
+        void* pointer = std::malloc(size ? size : 1);
+        if (pointer) {
+            GLEngine::AllocStats::onAllocate(size);
+        }
+        return pointer;
+    }
+
+    void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+        std::size_t align = (std::size_t)alignment;
+#ifdef _MSC_VER
+        void* pointer = _aligned_malloc(size ? size : 1, align);
+#else
+        // aligned_alloc wants a multiple of the alignment
+        void* pointer = std::aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align);
+#endif
+        if (pointer) {
+            GLEngine::AllocStats::onAllocate(size);
+        }
+        return pointer;
+    }
+
+    void deallocate(void* pointer) {
+        if (pointer) {
+            GLEngine::AllocStats::onFree();
+            std::free(pointer);
+        }
+    }
+
+    void deallocateAligned(void* pointer) {
+        if (pointer) {
+            GLEngine::AllocStats::onFree();
+#ifdef _MSC_VER
+            _aligned_free(pointer);
+#else
+            std::free(pointer);
+#endif
+        }
+    }
+}
+
+void* operator new(std::size_t size) {
+    void* pointer = allocate(size);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* pointer = allocateAligned(size, alignment);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { deallocateAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { deallocateAligned(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { deallocateAligned(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { deallocateAligned(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { deallocateAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { deallocateAligned(pointer); }
+#endif
\ No newline at end of file
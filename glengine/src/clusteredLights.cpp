@@ -0,0 +1,234 @@
+#include <glengine/clusteredLights.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define GLENGINE_CLUSTER_SSE
+#endif
+
+namespace GLEngine {
+    namespace {
+        // Signed distances from (x, z) to `count` planes through the eye, four at a time
+        void planeDistances(const float* nx, const float* nz, size_t count, float x, float z, float* out) {
+#ifdef GLENGINE_CLUSTER_SSE
+            const __m128 vx = _mm_set1_ps(x);
+            const __m128 vz = _mm_set1_ps(z);
+            for (size_t i = 0; i < count; i += 4) {
+                __m128 d = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(nx + i), vx), _mm_mul_ps(_mm_loadu_ps(nz + i), vz));
+                _mm_storeu_ps(out + i, d);
+            }
+#else
+            for (size_t i = 0; i < count; i++) {
+                out[i] = nx[i] * x + nz[i] * z;
+            }
+#endif
+        }
+
+        size_t paddedCount(unsigned int tiles) {
+            return ((tiles + 1) + 3) & ~size_t(3);
+        }
+    }
+
+    ClusteredLights::ClusteredLights(unsigned int tilesX, unsigned int tilesY, unsigned int slices, FrameArena* arena)
+    : tilesX(tilesX), tilesY(tilesY), slices(slices), boundsFovy(0.0f), boundsAspect(0.0f), arena(arena),
+      ranges(arena ? arena->getResource() : std::pmr::get_default_resource()),
+      visible(arena ? arena->getResource() : std::pmr::get_default_resource()), maxLightsPerCluster(0), nearPlane(1.0f), farPlane(1000.0f), zScale(0.0f), zBias(0.0f),
+      streamGeneration(0), lightTexture(0), gridTexture(0), indexTexture(0), lightOffset(0), gridOffset(0),
+      indexOffset(0), uploaded(false) {}
+
+    ClusteredLights::~ClusteredLights() {
+        cleanup();
+    }
+
+    void ClusteredLights::setupBoundaries(float fovy, float aspect) {
+        if (fovy == boundsFovy && aspect == boundsAspect) {
+            return;
+        }
+        boundsFovy = fovy;
+        boundsAspect = aspect;
+
+        float tanHalf = std::tan(fovy * 0.5f);
+        auto fill = [](unsigned int tiles, float scale, std::vector<float>& n, std::vector<float>& nz) {
+            n.assign(paddedCount(tiles), 0.0f);
+            nz.assign(paddedCount(tiles), 0.0f);
+            for (unsigned int b = 0; b <= tiles; b++) {
+                float k = (-1.0f + 2.0f * b / tiles) * scale;
+                float invLength = 1.0f / std::sqrt(1.0f + k * k);
+                n[b] = invLength;
+                nz[b] = k * invLength;
+            }
+        };
+        fill(tilesX, tanHalf * aspect, planesX, planesXz);
+        fill(tilesY, tanHalf, planesY, planesYz);
+        distances.resize(std::max(planesX.size(), planesY.size()));
+    }
+
+    bool ClusteredLights::computeRange(const glm::vec3& center, float radius, ClusterRange& range) {
+        float depth = -center.z;
+        if (depth + radius < nearPlane || depth - radius > farPlane) {
+            return false;
+        }
+
+        auto slice = [this](float d) {
+            int s = (int)(std::log(d) * zScale - zBias);
+            return (uint16_t)std::clamp(s, 0, (int)slices - 1);
+        };
+        range.z0 = slice(std::max(depth - radius, nearPlane));
+        range.z1 = slice(std::min(depth + radius, farPlane));
+
+        // A sphere reaching behind the eye plane may touch any tile
+        if (depth < radius) {
+            range.x0 = 0; range.x1 = tilesX - 1;
+            range.y0 = 0; range.y1 = tilesY - 1;
+            return true;
+        }
+
+        // Tile i lies between boundaries i and i + 1; distances decrease with i
+        auto tileRange = [&](unsigned int tiles, uint16_t& first, uint16_t& last) {
+            if (distances[0] <= -radius || distances[tiles] >= radius) {
+                return false;
+            }
+            unsigned int lo = 0;
+            while (lo + 1 < tiles && distances[lo + 1] >= radius) lo++;
+            unsigned int hi = tiles - 1;
+            while (hi > lo && distances[hi] <= -radius) hi--;
+            first = (uint16_t)lo;
+            last = (uint16_t)hi;
+            return true;
+        };
+
+        planeDistances(planesX.data(), planesXz.data(), planesX.size(), center.x, center.z, distances.data());
+        if (!tileRange(tilesX, range.x0, range.x1)) {
+            return false;
+        }
+        planeDistances(planesY.data(), planesYz.data(), planesY.size(), center.y, center.z, distances.data());
+        return tileRange(tilesY, range.y0, range.y1);
+    }
+
+    void ClusteredLights::build(const glm::mat4& view, float fovy, float aspect, float _nearPlane, float _farPlane) {
+        nearPlane = _nearPlane;
+        farPlane = _farPlane;
+        zScale = slices / std::log(farPlane / nearPlane);
+        zBias = std::log(nearPlane) * zScale;
+        setupBoundaries(fovy, aspect);
+
+        const unsigned int clusterCount = getClusterCount();
+        clusterGrid.assign(clusterCount * 2, 0);
+        if (arena) {
+            FrameArena::recycle(ranges);
+            FrameArena::recycle(visible);
+        }
+        ranges.resize(lights.size());
+        visible.assign(lights.size(), 0);
+
+        // First pass: bin every light and count the entries of each cluster
+        for (size_t i = 0; i < lights.size(); i++) {
+            glm::vec3 center = glm::vec3(view * glm::vec4(lights[i].position, 1.0f));
+            ClusterRange& r = ranges[i];
+            if (!computeRange(center, lights[i].radius, r)) {
+                continue;
+            }
+            visible[i] = 1;
+            for (unsigned int z = r.z0; z <= r.z1; z++)
+                for (unsigned int y = r.y0; y <= r.y1; y++)
+                    for (unsigned int x = r.x0; x <= r.x1; x++)
+                        clusterGrid[2 * (x + tilesX * (y + tilesY * z)) + 1]++;
+        }
+
+        // Prefix sum gives each cluster its offset in the index list
+        uint32_t offset = 0;
+        maxLightsPerCluster = 0;
+        for (unsigned int c = 0; c < clusterCount; c++) {
+            uint32_t count = clusterGrid[2 * c + 1];
+            clusterGrid[2 * c] = offset;
+            clusterGrid[2 * c + 1] = 0;
+            offset += count;
+            maxLightsPerCluster = std::max(maxLightsPerCluster, count);
+        }
+        lightIndices.resize(offset);
+
+        // Second pass: scatter light indices, the count is rebuilt as a cursor
+        for (size_t i = 0; i < lights.size(); i++) {
+            if (!visible[i]) {
+                continue;
+            }
+            const ClusterRange& r = ranges[i];
+            for (unsigned int z = r.z0; z <= r.z1; z++)
+                for (unsigned int y = r.y0; y <= r.y1; y++)
+                    for (unsigned int x = r.x0; x <= r.x1; x++) {
+                        uint32_t* cell = &clusterGrid[2 * (x + tilesX * (y + tilesY * z))];
+                        lightIndices[cell[0] + cell[1]++] = (uint32_t)i;
+                    }
+        }
+    }
+
+    bool ClusteredLights::upload(StreamBuffer& stream) {
+        // 16-byte alignment keeps every offset a whole texel of each format
+        size_t lightBytes = stream.write(lights.data(), lights.size() * sizeof(PointLight), 16);
+        size_t indexBytes = stream.write(lightIndices.data(), lightIndices.size() * sizeof(uint32_t), 16);
+        size_t gridBytes = stream.write(clusterGrid.data(), clusterGrid.size() * sizeof(uint32_t), 16);
+
+        uploaded = lightBytes != StreamBuffer::INVALID_OFFSET && indexBytes != StreamBuffer::INVALID_OFFSET &&
+                   gridBytes != StreamBuffer::INVALID_OFFSET;
+        if (!uploaded) {
+            return false;
+        }
+
+        if (lightTexture == 0) {
+            glGenTextures(1, &lightTexture);
+            glGenTextures(1, &gridTexture);
+            glGenTextures(1, &indexTexture);
+        }
+
+        // The views are only re-attached when the stream buffer was reallocated
+        if (stream.getGeneration() != streamGeneration) {
+            streamGeneration = stream.getGeneration();
+            glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, stream.getBuffer());
+            glBindTexture(GL_TEXTURE_BUFFER, gridTexture);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, stream.getBuffer());
+            glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, stream.getBuffer());
+            glBindTexture(GL_TEXTURE_BUFFER, 0);
+        }
+
+        lightOffset = (int)(lightBytes / (4 * sizeof(float)));
+        gridOffset = (int)(gridBytes / (2 * sizeof(uint32_t)));
+        indexOffset = (int)(indexBytes / sizeof(uint32_t));
+        return true;
+    }
+
+    void ClusteredLights::bind(const Shader& shader, int firstTextureUnit, const glm::ivec4& viewport) const {
+        const unsigned int textures[3] = { lightTexture, gridTexture, indexTexture };
+        for (int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE0 + firstTextureUnit + i);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+
+        shader.setInt("lightData", firstTextureUnit);
+        shader.setInt("clusterGrid", firstTextureUnit + 1);
+        shader.setInt("lightIndices", firstTextureUnit + 2);
+        shader.setInt("pointLightCount", uploaded ? (int)lights.size() : 0);
+        shader.setInt("lightDataOffset", lightOffset);
+        shader.setInt("clusterGridOffset", gridOffset);
+        shader.setInt("lightIndicesOffset", indexOffset);
+        shader.setIVec3("clusterDims", glm::ivec3(tilesX, tilesY, slices));
+        shader.setVec2("clusterOrigin", glm::vec2(viewport.x, viewport.y));
+        shader.setVec2("clusterTileSize", glm::vec2((float)viewport.z / tilesX, (float)viewport.w / tilesY));
+        shader.setFloat("clusterZScale", zScale);
+        shader.setFloat("clusterZBias", zBias);
+    }
+
+    void ClusteredLights::cleanup() {
+        if (lightTexture) {
+            unsigned int textures[3] = { lightTexture, gridTexture, indexTexture };
+            glDeleteTextures(3, textures);
+            lightTexture = gridTexture = indexTexture = 0;
+        }
+        streamGeneration = 0;
+        uploaded = false;
+    }
+}
\ No newline at end of file
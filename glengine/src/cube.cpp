@@ -3,7 +3,7 @@
 #include <vector>
 
 namespace GLEngine {
-    Cube::Cube(float size) {
+    Cube::Cube(float size) : VAO(0), VBO(0), EBO(0), memoryHandle(GpuMemory::INVALID_HANDLE) {
         setupCube(size);
     }
 
@@ -68,7 +68,6 @@ namespace GLEngine {
             22, 23, 20
         };
 
-        unsigned int VBO, EBO;
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
@@ -89,6 +88,9 @@ namespace GLEngine {
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
+
+        memoryHandle = GpuMemory::track(GpuMemory::Category::GEOMETRY, "Cube",
+            vertices.size() * sizeof(float) + indices.size() * sizeof(unsigned int));
     }
 
     void Cube::draw() const {
@@ -106,5 +108,10 @@ namespace GLEngine {
             glDeleteBuffers(1, &VBO);
             VBO = 0;
         }
+        if (EBO) {
+            glDeleteBuffers(1, &EBO);
+            EBO = 0;
+        }
+        GpuMemory::release(memoryHandle);
     }
 }
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include <glengine/depthPrepass.hpp>
+#include <glad/glad.h>
+
+namespace GLEngine {
+    DepthPrepass::DepthPrepass(float threshold, int probeInterval)
+    : mode(Mode::AUTO), threshold(threshold), probeInterval(probeInterval), active(false), autoEnabled(false),
+      frameIndex(0), querySets{}, current(0), measuring(false), depthComplexity(0.0f), shadedPerPixel(0.0f),
+      shadedFragments(0), coveredPixels(0) {}
+
+    DepthPrepass::~DepthPrepass() {
+        cleanup();
+    }
+
+    bool DepthPrepass::collect(QuerySet& set) {
+        if (!set.pending) {
+            return true;
+        }
+        // Reading a result the GPU has not produced yet would stall until it has
+        GLint available = 0;
+        glGetQueryObjectiv(set.shadingQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available && set.depthUsed) {
+            glGetQueryObjectiv(set.depthQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        }
+        if (!available) {
+            return false;
+        }
+        set.pending = false;
+
+        GLuint64 shading = 0;
+        glGetQueryObjectui64v(set.shadingQuery, GL_QUERY_RESULT, &shading);
+        shadedFragments = shading;
+
+        if (set.depthUsed) {
+            // With the pre-pass, the shading pass only touches visible pixels, while
+            // the depth pass counts what shading in submission order would have cost
+            GLuint64 depth = 0;
+            glGetQueryObjectui64v(set.depthQuery, GL_QUERY_RESULT, &depth);
+            coveredPixels = shading;
+            depthComplexity = shading ? (float)depth / (float)shading : 0.0f;
+
+            if (depthComplexity > threshold) {
+                autoEnabled = true;
+            } else if (depthComplexity < threshold * 0.8f) {
+                autoEnabled = false;
+            }
+        }
+
+        // Coverage comes from the last frame that ran the pre-pass
+        shadedPerPixel = coveredPixels ? (float)shading / (float)coveredPixels : 0.0f;
+        return true;
+    }
+
+    bool DepthPrepass::beginFrame(bool allowed) {
+        if (querySets[0].shadingQuery == 0) {
+            for (auto& set : querySets) {
+                glGenQueries(1, &set.depthQuery);
+                glGenQueries(1, &set.shadingQuery);
+            }
+        }
+
+        // Finished sets are read oldest first and the next free one counts this frame;
+        // the others stay pending until a later frame
+        int next = -1;
+        for (int i = 1; i <= QUERY_LATENCY; i++) {
+            int index = (current + i) % QUERY_LATENCY;
+            if (collect(querySets[index]) && next < 0) {
+                next = index;
+            }
+        }
+        measuring = next >= 0;
+        if (measuring) {
+            current = next;
+        }
+
+        switch (mode) {
+            case Mode::OFF:
+                active = false;
+                break;
+            case Mode::ON:
+                active = true;
+                break;
+            case Mode::AUTO:
+                active = autoEnabled || (probeInterval > 0 && frameIndex % probeInterval == 0);
+                break;
+        }
+        active = active && allowed;
+        frameIndex++;
+
+        if (measuring) {
+            querySets[current].depthUsed = active;
+        }
+        return active;
+    }
+
+    void DepthPrepass::beginDepthPass() {
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+        if (measuring) {
+            glBeginQuery(GL_SAMPLES_PASSED, querySets[current].depthQuery);
+        }
+    }
+
+    void DepthPrepass::endDepthPass() {
+        if (measuring) {
+            glEndQuery(GL_SAMPLES_PASSED);
+        }
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    }
+
+    void DepthPrepass::beginShadingPass() {
+        if (active) {
+            glDepthFunc(GL_LEQUAL);
+            glDepthMask(GL_FALSE);
+        }
+        if (measuring) {
+            glBeginQuery(GL_SAMPLES_PASSED, querySets[current].shadingQuery);
+        }
+    }
+
+    void DepthPrepass::endShadingPass() {
+        if (measuring) {
+            glEndQuery(GL_SAMPLES_PASSED);
+            querySets[current].pending = true;
+        }
+        if (active) {
+            glDepthFunc(GL_LESS);
+            glDepthMask(GL_TRUE);
+        }
+    }
+
+    void DepthPrepass::cleanup() {
+        for (auto& set : querySets) {
+            if (set.shadingQuery) {
+                glDeleteQueries(1, &set.depthQuery);
+                glDeleteQueries(1, &set.shadingQuery);
+            }
+            set = QuerySet{};
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include <glengine/dynamicResolution.hpp>
+#include <glengine/trace.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace GLEngine {
+    DynamicResolution::DynamicResolution(float budgetMs, float minScale, float maxScale)
+    : FBO(0), colorTexture(0), depthRenderbuffer(0), emptyVAO(0),
+      memoryHandle(GpuMemory::INVALID_HANDLE), width(0), height(0),
+      renderWidth(0), renderHeight(0), budgetMs(budgetMs), minScale(minScale), maxScale(maxScale),
+      scale(maxScale), hysteresis(0.1f), sharpness(0.5f), autoScale(true), queries{}, current(0), timing(false),
+      gpuTimeMs(0.0f), samples(0) {}
+
+    DynamicResolution::~DynamicResolution() {
+        cleanup();
+    }
+
+    void DynamicResolution::resize(int _width, int _height) {
+        _width = std::max(_width, 1);
+        _height = std::max(_height, 1);
+        if (FBO != 0 && _width == width && _height == height) {
+            return;
+        }
+        if (FBO) {
+            glDeleteFramebuffers(1, &FBO);
+            glDeleteTextures(1, &colorTexture);
+            glDeleteRenderbuffers(1, &depthRenderbuffer);
+        }
+        width = _width;
+        height = _height;
+
+        // Allocated at the output size, lower scales only use the bottom-left corner
+        glGenTextures(1, &colorTexture);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // Same format as the G-buffer depth so it can be blitted in
+        glGenRenderbuffers(1, &depthRenderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            throw std::runtime_error("Dynamic resolution framebuffer is incomplete");
+        }
+
+        if (memoryHandle == GpuMemory::INVALID_HANDLE) {
+            memoryHandle = GpuMemory::track(GpuMemory::Category::RENDER_TARGET, "DynamicResolution", getMemorySize());
+        } else {
+            GpuMemory::resize(memoryHandle, getMemorySize());
+        }
+    }
+
+    void DynamicResolution::setScale(float _scale) {
+        _scale = std::clamp(_scale, minScale, maxScale);
+        if (_scale != scale) {
+            scale = _scale;
+            samples = 0;
+        }
+    }
+
+    bool DynamicResolution::collect(TimerQuery& timer) {
+        if (!timer.pending) {
+            return true;
+        }
+        // Reading a result the GPU has not produced yet would stall until it has
+        GLint available = 0;
+        glGetQueryObjectiv(timer.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            return false;
+        }
+        timer.pending = false;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(timer.query, GL_QUERY_RESULT, &elapsed);
+
+        // Frames rendered before the last scale change say nothing about the current one
+        if (timer.scale != scale) {
+            return true;
+        }
+        float ms = (float)elapsed * 1e-6f;
+        gpuTimeMs = samples == 0 ? ms : gpuTimeMs + 0.2f * (ms - gpuTimeMs);
+        samples++;
+        return true;
+    }
+
+    void DynamicResolution::beginFrame(int outputWidth, int outputHeight) {
+        resize(outputWidth, outputHeight);
+        if (queries[0].query == 0) {
+            for (auto& timer : queries) {
+                glGenQueries(1, &timer.query);
+            }
+            glGenVertexArrays(1, &emptyVAO);
+        }
+
+        // Finished queries are read oldest first and the next free one times this frame;
+        // the others stay pending until a later frame
+        int next = -1;
+        for (int i = 1; i <= QUERY_LATENCY; i++) {
+            int index = (current + i) % QUERY_LATENCY;
+            if (collect(queries[index]) && next < 0) {
+                next = index;
+            }
+        }
+        timing = next >= 0;
+        if (timing) {
+            current = next;
+        }
+
+        if (autoScale && samples >= SETTLE_SAMPLES && gpuTimeMs > 0.0f) {
+            float ratio = budgetMs / gpuTimeMs;
+            bool overBudget = ratio < 1.0f - hysteresis;
+            bool underBudget = ratio > 1.0f + hysteresis && scale < maxScale;
+            if (overBudget || underBudget) {
+                // GPU time is roughly proportional to the pixel count, i.e. to scale^2;
+                // drop quickly and recover slowly
+                float target = scale * std::sqrt(ratio);
+                float step = overBudget ? 0.1f : 0.05f;
+                setScale(std::clamp(target, scale - step, scale + step));
+            }
+        }
+
+        renderWidth = std::max((int)std::lround(width * scale), 1);
+        renderHeight = std::max((int)std::lround(height * scale), 1);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glViewport(0, 0, renderWidth, renderHeight);
+
+        if (timing) {
+            queries[current].scale = scale;
+            glBeginQuery(GL_TIME_ELAPSED, queries[current].query);
+        }
+    }
+
+    void DynamicResolution::endFrame() {
+        if (timing) {
+            glEndQuery(GL_TIME_ELAPSED);
+            queries[current].pending = true;
+        }
+    }
+
+    void DynamicResolution::present(const Shader& upscaleShader, unsigned int framebuffer) const {
+        GLENGINE_TRACE_ZONE("DynamicResolution::present");
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, width, height);
+        glDisable(GL_DEPTH_TEST);
+        // A leftover wireframe mode would draw the fullscreen triangle as three lines
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+        upscaleShader.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        upscaleShader.setInt("sceneTexture", 0);
+        upscaleShader.setVec2("texCoordScale", glm::vec2((float)renderWidth / width, (float)renderHeight / height));
+        upscaleShader.setVec2("texelSize", glm::vec2(1.0f / width, 1.0f / height));
+        // Nothing to restore at native resolution
+        upscaleShader.setFloat("sharpness", renderWidth < width || renderHeight < height ? sharpness : 0.0f);
+
+        glBindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    size_t DynamicResolution::getMemorySize() const {
+        // RGBA8 + D24S8
+        return FBO ? (size_t)width * height * (4 + 4) : 0;
+    }
+
+    void DynamicResolution::cleanup() {
+        if (FBO) {
+            glDeleteFramebuffers(1, &FBO);
+            glDeleteTextures(1, &colorTexture);
+            glDeleteRenderbuffers(1, &depthRenderbuffer);
+            FBO = colorTexture = depthRenderbuffer = 0;
+        }
+        GpuMemory::release(memoryHandle);
+        if (emptyVAO) {
+            glDeleteVertexArrays(1, &emptyVAO);
+            emptyVAO = 0;
+        }
+        for (auto& timer : queries) {
+            if (timer.query) {
+                glDeleteQueries(1, &timer.query);
+            }
+            timer = TimerQuery{};
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include <glengine/frameArena.hpp>
+#include <algorithm>
+
+namespace GLEngine {
+    class FrameArena::ThreadArena : public std::pmr::memory_resource {
+    public:
+        explicit ThreadArena(size_t blockSize) : blockSize(blockSize), current(0), lastUsed(0), highWater(0), overflows(0) {}
+
+        void flip() {
+            lastUsed = halves[current].used;
+            highWater = std::max(highWater, lastUsed);
+            current ^= 1;
+
+            // Frame N-2 is over; blocks added by an overflow become one block large enough for all of them
+            Half& half = halves[current];
+            if (half.blocks.size() > 1) {
+                size_t total = 0;
+                for (const Block& block : half.blocks) {
+                    total += block.size;
+                }
+                half.blocks.clear();
+                half.blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[total]), total });
+            }
+            half.offset = 0;
+            half.used = 0;
+        }
+
+        Stats getStats() const {
+            Stats stats;
+            stats.used = lastUsed;
+            stats.highWater = highWater;
+            for (const Half& half : halves) {
+                for (const Block& block : half.blocks) {
+                    stats.capacity += block.size;
+                }
+            }
+            stats.overflows = overflows;
+            return stats;
+        }
+
+    private:
+        struct Block {
+            std::unique_ptr<unsigned char[]> data;
+            size_t size;
+        };
+
+        // Bump allocation in the last block only
+        struct Half {
+            std::vector<Block> blocks;
+            size_t offset = 0;
+            size_t used = 0;
+        };
+
+        size_t blockSize;
+        Half halves[2];
+        unsigned int current;
+        size_t lastUsed;
+        size_t highWater;
+        uint64_t overflows;
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            Half& half = halves[current];
+            if (!half.blocks.empty()) {
+                void* pointer = bump(half, bytes, alignment);
+                if (pointer) {
+                    return pointer;
+                }
+                overflows++;
+            }
+            size_t size = std::max(blockSize, bytes + alignment);
+            half.blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[size]), size });
+            half.offset = 0;
+            return bump(half, bytes, alignment);
+        }
+
+        // Only the latest allocation can be taken back, which covers a vector growing in place of its last buffer
+        void do_deallocate(void* pointer, size_t bytes, size_t) override {
+            Half& half = halves[current];
+            if (half.blocks.empty()) {
+                return;
+            }
+            unsigned char* base = half.blocks.back().data.get();
+            if ((unsigned char*)pointer + bytes == base + half.offset && (unsigned char*)pointer >= base) {
+                half.offset -= bytes;
+                half.used -= bytes;
+            }
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        void* bump(Half& half, size_t bytes, size_t alignment) {
+            Block& block = half.blocks.back();
+            uintptr_t base = (uintptr_t)block.data.get();
+            size_t start = (size_t)(((base + half.offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base);
+            if (start + bytes > block.size) {
+                return nullptr;
+            }
+            half.used += start - half.offset + bytes;
+            half.offset = start + bytes;
+            return block.data.get() + start;
+        }
+    };
+
+    FrameArena::FrameArena(unsigned int threadCount, size_t blockSize) : frame(0) {
+        threadCount = std::max(threadCount, 1u);
+        threads.reserve(threadCount);
+        for (unsigned int i = 0; i < threadCount; i++) {
+            threads.push_back(std::make_unique<ThreadArena>(blockSize));
+        }
+    }
+
+    FrameArena::~FrameArena() = default;
+
+    void FrameArena::beginFrame() {
+        for (auto& thread : threads) {
+            thread->flip();
+        }
+        frame++;
+    }
+
+    std::pmr::memory_resource* FrameArena::getResource(unsigned int thread) {
+        return threads[thread].get();
+    }
+
+    FrameArena::Stats FrameArena::getStats() const {
+        Stats total;
+        for (const auto& thread : threads) {
+            Stats stats = thread->getStats();
+            total.used += stats.used;
+            total.highWater += stats.highWater;
+            total.capacity += stats.capacity;
+            total.overflows += stats.overflows;
+        }
+        return total;
+    }
+
+    FrameArena::Stats FrameArena::getStats(unsigned int thread) const {
+        return threads[thread]->getStats();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include <glengine/frameCapture.hpp>
+#include <stbimage/stb_image_write.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace GLEngine {
+    FrameCapture::FrameCapture(int ringSize, unsigned int workerCount)
+    : ringSize(ringSize), next(0), memoryHandle(GpuMemory::INVALID_HANDLE), recording(false), recordingFormat(Format::PNG), recordingIndex(0),
+      jpegQuality(90), capturedFrames(0), droppedFrames(0), encodedFrames(0), failedFrames(0),
+      encoders(workerCount) {
+        // OpenGL rows start at the bottom of the image
+        stbi_flip_vertically_on_write(1);
+    }
+
+    FrameCapture::~FrameCapture() {
+        cleanup();
+    }
+
+    void FrameCapture::requestScreenshot(const std::string& path) {
+        std::error_code error;
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty()) {
+            std::filesystem::create_directories(parent, error);
+        }
+        screenshotPath = path;
+    }
+
+    void FrameCapture::startRecording(const std::string& directory, Format format) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        recordingDirectory = directory;
+        recordingFormat = format;
+        recordingIndex = 0;
+        recording = true;
+    }
+
+    void FrameCapture::stopRecording() {
+        recording = false;
+    }
+
+    bool FrameCapture::hasPendingReadbacks() const {
+        for (const auto& slot : slots) {
+            if (slot.fence) {
+                return true;
+            }
+        }
+        return !screenshotPath.empty();
+    }
+
+    void FrameCapture::capture(int width, int height, unsigned int framebuffer) {
+        if (slots.empty()) {
+            slots.resize(ringSize);
+            for (auto& slot : slots) {
+                glGenBuffers(1, &slot.pbo);
+                slot.capacity = 0;
+                slot.fence = nullptr;
+            }
+        }
+
+        // Hand finished readbacks to the encoders without waiting on the GPU
+        collect(false);
+
+        bool screenshot = !screenshotPath.empty();
+        if ((!screenshot && !recording) || width <= 0 || height <= 0) {
+            return;
+        }
+
+        // Ring full or encoders behind: a screenshot waits for the next frame, a recorded frame is dropped
+        Slot& slot = slots[next];
+        bool encodersBehind = encoders.getPendingCount() >= encoders.getThreadCount() * 2;
+        if (slot.fence || (!screenshot && encodersBehind)) {
+            if (!screenshot) {
+                droppedFrames++;
+            }
+            return;
+        }
+
+        if (screenshot) {
+            slot.path = screenshotPath;
+            std::string extension = std::filesystem::path(slot.path).extension().string();
+            slot.format = extension == ".jpg" || extension == ".jpeg" ? Format::JPEG : Format::PNG;
+            screenshotPath.clear();
+        } else {
+            char name[32];
+            std::snprintf(name, sizeof(name), "frame_%06llu.%s", (unsigned long long)recordingIndex++,
+                recordingFormat == Format::JPEG ? "jpg" : "png");
+            slot.path = (std::filesystem::path(recordingDirectory) / name).string();
+            slot.format = recordingFormat;
+        }
+        slot.width = width;
+        slot.height = height;
+
+        size_t size = (size_t)width * height * 4;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        if (slot.capacity < size) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            slot.capacity = size;
+
+            size_t ringBytes = 0;
+            for (const Slot& ringSlot : slots) {
+                ringBytes += ringSlot.capacity;
+            }
+            if (memoryHandle == GpuMemory::INVALID_HANDLE) {
+                memoryHandle = GpuMemory::track(GpuMemory::Category::READBACK, "FrameCapture", ringBytes);
+            } else {
+                GpuMemory::resize(memoryHandle, ringBytes);
+            }
+        }
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // Make sure the fence reaches the GPU so polling can see it signaled
+        glFlush();
+
+        next = (next + 1) % ringSize;
+        capturedFrames++;
+    }
+
+    void FrameCapture::collect(bool block) {
+        for (int i = 0; i < (int)slots.size(); i++) {
+            // Oldest readbacks first
+            Slot& slot = slots[(next + i) % slots.size()];
+            if (!slot.fence) {
+                continue;
+            }
+            GLenum status = glClientWaitSync(slot.fence, 0, block ? 1000000000ull : 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                continue;
+            }
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+
+            std::vector<unsigned char> pixels;
+            {
+                std::lock_guard<std::mutex> lock(bufferMutex);
+                if (!freeBuffers.empty()) {
+                    pixels = std::move(freeBuffers.back());
+                    freeBuffers.pop_back();
+                }
+            }
+            size_t size = (size_t)slot.width * slot.height * 4;
+            pixels.resize(size);
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+            if (data) {
+                std::memcpy(pixels.data(), data, size);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            if (!data) {
+                failedFrames++;
+                continue;
+            }
+
+            int width = slot.width, height = slot.height;
+            std::string path = slot.path;
+            Format format = slot.format;
+            encoders.submit([this, pixels = std::move(pixels), width, height, path, format]() mutable {
+                encode(std::move(pixels), width, height, path, format);
+            });
+        }
+    }
+
+    void FrameCapture::encode(std::vector<unsigned char> pixels, int width, int height, const std::string& path, Format format) {
+        // Drop the alpha channel in place, both encoders then get packed RGB
+        size_t pixelCount = (size_t)width * height;
+        for (size_t i = 0; i < pixelCount; i++) {
+            pixels[i * 3 + 0] = pixels[i * 4 + 0];
+            pixels[i * 3 + 1] = pixels[i * 4 + 1];
+            pixels[i * 3 + 2] = pixels[i * 4 + 2];
+        }
+
+        int ok = format == Format::JPEG
+            ? stbi_write_jpg(path.c_str(), width, height, 3, pixels.data(), jpegQuality)
+            : stbi_write_png(path.c_str(), width, height, 3, pixels.data(), width * 3);
+        if (ok) {
+            encodedFrames++;
+        } else {
+            failedFrames++;
+            std::cerr << "ERROR::FRAME_CAPTURE::WRITE_FAILED: " << path << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        freeBuffers.push_back(std::move(pixels));
+    }
+
+    void FrameCapture::flush() {
+        collect(true);
+        encoders.wait();
+    }
+
+    void FrameCapture::cleanup() {
+        if (slots.empty()) {
+            return;
+        }
+        flush();
+        for (auto& slot : slots) {
+            if (slot.fence) {
+                glDeleteSync(slot.fence);
+            }
+            glDeleteBuffers(1, &slot.pbo);
+        }
+        slots.clear();
+        GpuMemory::release(memoryHandle);
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        freeBuffers.clear();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include <glengine/gbuffer.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace GLEngine {
+    GBuffer::GBuffer() : FBO(0), normalTexture(0), albedoTexture(0), materialTexture(0), depthTexture(0), emptyVAO(0),
+      memoryHandle(GpuMemory::INVALID_HANDLE), width(0), height(0),
+      renderWidth(0), renderHeight(0) {}
+
+    GBuffer::~GBuffer() {
+        cleanup();
+    }
+
+    void GBuffer::resize(int _width, int _height) {
+        if (FBO != 0 && _width == width && _height == height) {
+            return;
+        }
+        cleanup();
+        width = std::max(_width, 1);
+        height = std::max(_height, 1);
+        renderWidth = width;
+        renderHeight = height;
+
+        auto createTexture = [this](GLint internalFormat, GLenum format, GLenum type) {
+            unsigned int texture;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            return texture;
+        };
+
+        normalTexture = createTexture(GL_RG16, GL_RG, GL_UNSIGNED_SHORT);
+        albedoTexture = createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        materialTexture = createTexture(GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+        depthTexture = createTexture(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, normalTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, albedoTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, materialTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+
+        const GLenum drawBuffers[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+        glDrawBuffers(3, drawBuffers);
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            throw std::runtime_error("G-buffer framebuffer is incomplete");
+        }
+
+        // Core profile needs a bound VAO even for attribute-less draws
+        glGenVertexArrays(1, &emptyVAO);
+        memoryHandle = GpuMemory::track(GpuMemory::Category::RENDER_TARGET, "GBuffer", getMemorySize());
+    }
+
+    void GBuffer::setRenderSize(int _width, int _height) {
+        renderWidth = std::min(std::max(_width, 1), width);
+        renderHeight = std::min(std::max(_height, 1), height);
+    }
+
+    glm::vec4 GBuffer::getTexCoordRect(const glm::ivec4& viewport) const {
+        return FBO ? glm::vec4(viewport) / glm::vec4(width, height, width, height) : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    }
+
+    void GBuffer::bindForWriting() const {
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glViewport(0, 0, renderWidth, renderHeight);
+    }
+
+    void GBuffer::bindTextures(int firstTextureUnit) const {
+        const unsigned int textures[4] = { normalTexture, albedoTexture, depthTexture, materialTexture };
+        for (int i = 0; i < 4; i++) {
+            glActiveTexture(GL_TEXTURE0 + firstTextureUnit + i);
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void GBuffer::blitDepthTo(unsigned int framebuffer) const {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+        glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, renderWidth, renderHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+
+    void GBuffer::drawFullscreen() const {
+        glBindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+    }
+
+    size_t GBuffer::getMemorySize() const {
+        // RG16 + RGBA8 + R8 + D24S8
+        return FBO ? (size_t)width * height * (4 + 4 + 1 + 4) : 0;
+    }
+
+    void GBuffer::cleanup() {
+        if (FBO) {
+            glDeleteFramebuffers(1, &FBO);
+            FBO = 0;
+        }
+        if (normalTexture) {
+            unsigned int textures[4] = { normalTexture, albedoTexture, materialTexture, depthTexture };
+            glDeleteTextures(4, textures);
+            normalTexture = albedoTexture = materialTexture = depthTexture = 0;
+        }
+        if (emptyVAO) {
+            glDeleteVertexArrays(1, &emptyVAO);
+            emptyVAO = 0;
+        }
+        GpuMemory::release(memoryHandle);
+    }
+
+    bool computeLightScissor(const glm::vec3& center, float radius, const glm::mat4& view,
+                             const glm::mat4& projection, int width, int height, glm::ivec4& rect) {
+        glm::vec3 viewCenter = glm::vec3(view * glm::vec4(center, 1.0f));
+
+        // Sphere crossing the eye plane: fall back to the whole screen
+        if (viewCenter.z + radius > -1e-3f) {
+            if (viewCenter.z - radius > 0.0f) {
+                return false;
+            }
+            rect = glm::ivec4(0, 0, width, height);
+            return true;
+        }
+
+        // Project the corners of the view-space bounding box
+        glm::vec2 minNdc(1.0f), maxNdc(-1.0f);
+        for (int i = 0; i < 8; i++) {
+            glm::vec3 corner = viewCenter + radius * glm::vec3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+            glm::vec4 clip = projection * glm::vec4(corner, 1.0f);
+            glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            minNdc = glm::min(minNdc, ndc);
+            maxNdc = glm::max(maxNdc, ndc);
+        }
+        minNdc = glm::clamp(minNdc, glm::vec2(-1.0f), glm::vec2(1.0f));
+        maxNdc = glm::clamp(maxNdc, glm::vec2(-1.0f), glm::vec2(1.0f));
+        if (minNdc.x >= maxNdc.x || minNdc.y >= maxNdc.y) {
+            return false;
+        }
+
+        int x0 = (int)((minNdc.x * 0.5f + 0.5f) * width);
+        int y0 = (int)((minNdc.y * 0.5f + 0.5f) * height);
+        int x1 = (int)((maxNdc.x * 0.5f + 0.5f) * width) + 1;
+        int y1 = (int)((maxNdc.y * 0.5f + 0.5f) * height) + 1;
+        rect = glm::ivec4(x0, y0, std::min(x1, width) - x0, std::min(y1, height) - y0);
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,417 @@
+#include <glengine/geometryPool.hpp>
+#include <glengine/mesh.hpp>
+#include <glengine/trace.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+
+namespace GLEngine {
+    namespace {
+        unsigned int createBuffer(size_t bytes) {
+            unsigned int buffer;
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, bytes, nullptr, GL_STATIC_DRAW);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            return buffer;
+        }
+
+        void copyBuffer(unsigned int source, unsigned int destination, size_t sourceOffset, size_t destinationOffset, size_t bytes) {
+            glBindBuffer(GL_COPY_READ_BUFFER, source);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, destinationOffset, bytes);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+
+        void uploadBuffer(unsigned int buffer, size_t offset, size_t bytes, const void* data) {
+            // The copy target leaves the element binding of the current VAO untouched
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, offset, bytes, data);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+    }
+
+    void GeometryPool::RangeAllocator::reset(size_t newCapacity) {
+        freeBlocks.clear();
+        capacity = newCapacity;
+        if (capacity > 0) {
+            freeBlocks.emplace(0, capacity);
+        }
+    }
+
+    bool GeometryPool::RangeAllocator::allocate(size_t size, size_t& offset) {
+        // Best fit keeps large blocks available for large meshes
+        auto best = freeBlocks.end();
+        for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+            if (it->second >= size && (best == freeBlocks.end() || it->second < best->second)) {
+                best = it;
+                if (it->second == size) {
+                    break;
+                }
+            }
+        }
+        if (best == freeBlocks.end()) {
+            return false;
+        }
+
+        offset = best->first;
+        size_t remaining = best->second - size;
+        freeBlocks.erase(best);
+        if (remaining > 0) {
+            freeBlocks.emplace(offset + size, remaining);
+        }
+        return true;
+    }
+
+    void GeometryPool::RangeAllocator::release(size_t offset, size_t size) {
+        if (size == 0) {
+            return;
+        }
+
+        auto it = freeBlocks.emplace(offset, size).first;
+
+        auto next = std::next(it);
+        if (next != freeBlocks.end() && it->first + it->second == next->first) {
+            it->second += next->second;
+            freeBlocks.erase(next);
+        }
+
+        if (it != freeBlocks.begin()) {
+            auto previous = std::prev(it);
+            if (previous->first + previous->second == it->first) {
+                previous->second += it->second;
+                freeBlocks.erase(it);
+            }
+        }
+    }
+
+    void GeometryPool::RangeAllocator::grow(size_t newCapacity) {
+        if (newCapacity > capacity) {
+            size_t oldCapacity = capacity;
+            capacity = newCapacity;
+            release(oldCapacity, newCapacity - oldCapacity);
+        }
+    }
+
+    size_t GeometryPool::RangeAllocator::getFree() const {
+        size_t total = 0;
+        for (const auto& block : freeBlocks) {
+            total += block.second;
+        }
+        return total;
+    }
+
+    size_t GeometryPool::RangeAllocator::getLargestFree() const {
+        size_t largest = 0;
+        for (const auto& block : freeBlocks) {
+            largest = std::max(largest, block.second);
+        }
+        return largest;
+    }
+
+    GeometryPool::GeometryPool(size_t initialVertices, size_t initialIndices)
+    : VAO(0), VBO(0), EBO(0), depthVAO(0), positionVBO(0), initialVertices(initialVertices),
+      initialIndices(initialIndices), generation(0), growCount(0), defragmentCount(0),
+      memoryHandle(GpuMemory::INVALID_HANDLE) {}
+
+    GeometryPool::~GeometryPool() {
+        cleanup();
+    }
+
+    GeometryPool::Handle GeometryPool::allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+        GLENGINE_TRACE_ZONE("GeometryPool::allocate");
+        if (vertices.empty() || indices.empty()) {
+            return INVALID_HANDLE;
+        }
+
+        if (VBO == 0) {
+            createBuffers(std::max(initialVertices, vertices.size()), std::max(initialIndices, indices.size()));
+            vertexAllocator.reset(std::max(initialVertices, vertices.size()));
+            indexAllocator.reset(std::max(initialIndices, indices.size()));
+            setupVertexArrays();
+        }
+
+        size_t vertexOffset = 0, indexOffset = 0;
+        bool vertexFit = vertexAllocator.allocate(vertices.size(), vertexOffset);
+        bool indexFit = indexAllocator.allocate(indices.size(), indexOffset);
+
+        if (!vertexFit || !indexFit) {
+            if (vertexFit) {
+                vertexAllocator.release(vertexOffset, vertices.size());
+            }
+            if (indexFit) {
+                indexAllocator.release(indexOffset, indices.size());
+            }
+
+            // Scattered free space is compacted first, the buffers only grow when still short
+            if (vertexAllocator.getBlockCount() > 1 || indexAllocator.getBlockCount() > 1) {
+                defragment();
+            }
+
+            size_t vertexUsed = vertexAllocator.getCapacity() - vertexAllocator.getFree();
+            size_t vertexCapacity = vertexAllocator.getCapacity();
+            while (vertexCapacity - vertexUsed < vertices.size()) {
+                vertexCapacity *= 2;
+            }
+            size_t indexUsed = indexAllocator.getCapacity() - indexAllocator.getFree();
+            size_t indexCapacity = indexAllocator.getCapacity();
+            while (indexCapacity - indexUsed < indices.size()) {
+                indexCapacity *= 2;
+            }
+            reserve(vertexCapacity, indexCapacity);
+
+            vertexAllocator.allocate(vertices.size(), vertexOffset);
+            indexAllocator.allocate(indices.size(), indexOffset);
+        }
+
+        // Position-only copy for the depth passes, at the same vertex offsets
+        std::vector<glm::vec3> positions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            positions[i] = vertices[i].position;
+        }
+
+        uploadBuffer(VBO, vertexOffset * sizeof(Vertex), vertices.size() * sizeof(Vertex), vertices.data());
+        uploadBuffer(positionVBO, vertexOffset * sizeof(glm::vec3), positions.size() * sizeof(glm::vec3), positions.data());
+        uploadBuffer(EBO, indexOffset * sizeof(unsigned int), indices.size() * sizeof(unsigned int), indices.data());
+
+        Handle handle;
+        if (!freeHandles.empty()) {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        } else {
+            handle = (Handle)allocations.size();
+            allocations.emplace_back();
+        }
+
+        Allocation& allocation = allocations[handle];
+        allocation.range.vertexOffset = (unsigned int)vertexOffset;
+        allocation.range.vertexCount = (unsigned int)vertices.size();
+        allocation.range.indexOffset = (unsigned int)indexOffset;
+        allocation.range.indexCount = (unsigned int)indices.size();
+        allocation.live = true;
+        return handle;
+    }
+
+    void GeometryPool::release(Handle handle) {
+        if (handle >= allocations.size() || !allocations[handle].live) {
+            return;
+        }
+
+        Allocation& allocation = allocations[handle];
+        vertexAllocator.release(allocation.range.vertexOffset, allocation.range.vertexCount);
+        indexAllocator.release(allocation.range.indexOffset, allocation.range.indexCount);
+        allocation.range = Range();
+        allocation.live = false;
+        freeHandles.push_back(handle);
+    }
+
+    void GeometryPool::defragment(bool shrink) {
+        if (VBO == 0) {
+            return;
+        }
+
+        std::vector<Handle> live;
+        for (Handle handle = 0; handle < allocations.size(); handle++) {
+            if (allocations[handle].live) {
+                live.push_back(handle);
+            }
+        }
+
+        size_t vertexCapacity = vertexAllocator.getCapacity();
+        size_t indexCapacity = indexAllocator.getCapacity();
+        if (shrink) {
+            vertexCapacity = std::max(initialVertices, vertexCapacity - vertexAllocator.getFree());
+            indexCapacity = std::max(initialIndices, indexCapacity - indexAllocator.getFree());
+        }
+
+        unsigned int oldVBO = VBO, oldPositionVBO = positionVBO, oldEBO = EBO;
+        createBuffers(vertexCapacity, indexCapacity);
+
+        // Ranges keep their relative order, so the copies never overlap
+        std::sort(live.begin(), live.end(), [this](Handle a, Handle b) {
+            return allocations[a].range.vertexOffset < allocations[b].range.vertexOffset;
+        });
+        size_t vertexEnd = 0;
+        for (Handle handle : live) {
+            Range& range = allocations[handle].range;
+            copyBuffer(oldVBO, VBO, range.vertexOffset * sizeof(Vertex), vertexEnd * sizeof(Vertex),
+                range.vertexCount * sizeof(Vertex));
+            copyBuffer(oldPositionVBO, positionVBO, range.vertexOffset * sizeof(glm::vec3), vertexEnd * sizeof(glm::vec3),
+                range.vertexCount * sizeof(glm::vec3));
+            range.vertexOffset = (unsigned int)vertexEnd;
+            vertexEnd += range.vertexCount;
+        }
+
+        std::sort(live.begin(), live.end(), [this](Handle a, Handle b) {
+            return allocations[a].range.indexOffset < allocations[b].range.indexOffset;
+        });
+        size_t indexEnd = 0;
+        for (Handle handle : live) {
+            Range& range = allocations[handle].range;
+            copyBuffer(oldEBO, EBO, range.indexOffset * sizeof(unsigned int), indexEnd * sizeof(unsigned int),
+                range.indexCount * sizeof(unsigned int));
+            range.indexOffset = (unsigned int)indexEnd;
+            indexEnd += range.indexCount;
+        }
+
+        glDeleteBuffers(1, &oldVBO);
+        glDeleteBuffers(1, &oldPositionVBO);
+        glDeleteBuffers(1, &oldEBO);
+        setupVertexArrays();
+
+        size_t offset;
+        vertexAllocator.reset(vertexCapacity);
+        indexAllocator.reset(indexCapacity);
+        if (vertexEnd > 0) {
+            vertexAllocator.allocate(vertexEnd, offset);
+        }
+        if (indexEnd > 0) {
+            indexAllocator.allocate(indexEnd, offset);
+        }
+
+        generation++;
+        defragmentCount++;
+    }
+
+    void GeometryPool::reserve(size_t vertexCapacity, size_t indexCapacity) {
+        size_t oldVertexCapacity = vertexAllocator.getCapacity();
+        size_t oldIndexCapacity = indexAllocator.getCapacity();
+        if (vertexCapacity <= oldVertexCapacity && indexCapacity <= oldIndexCapacity) {
+            return;
+        }
+        vertexCapacity = std::max(vertexCapacity, oldVertexCapacity);
+        indexCapacity = std::max(indexCapacity, oldIndexCapacity);
+
+        unsigned int oldVBO = VBO, oldPositionVBO = positionVBO, oldEBO = EBO;
+        createBuffers(vertexCapacity, indexCapacity);
+
+        copyBuffer(oldVBO, VBO, 0, 0, oldVertexCapacity * sizeof(Vertex));
+        copyBuffer(oldPositionVBO, positionVBO, 0, 0, oldVertexCapacity * sizeof(glm::vec3));
+        copyBuffer(oldEBO, EBO, 0, 0, oldIndexCapacity * sizeof(unsigned int));
+
+        glDeleteBuffers(1, &oldVBO);
+        glDeleteBuffers(1, &oldPositionVBO);
+        glDeleteBuffers(1, &oldEBO);
+        setupVertexArrays();
+
+        vertexAllocator.grow(vertexCapacity);
+        indexAllocator.grow(indexCapacity);
+
+        generation++;
+        growCount++;
+    }
+
+    void GeometryPool::createBuffers(size_t vertexCapacity, size_t indexCapacity) {
+        VBO = createBuffer(vertexCapacity * sizeof(Vertex));
+        positionVBO = createBuffer(vertexCapacity * sizeof(glm::vec3));
+        EBO = createBuffer(indexCapacity * sizeof(unsigned int));
+
+        size_t bytes = vertexCapacity * (sizeof(Vertex) + sizeof(glm::vec3)) + indexCapacity * sizeof(unsigned int);
+        if (memoryHandle == GpuMemory::INVALID_HANDLE) {
+            memoryHandle = GpuMemory::track(GpuMemory::Category::GEOMETRY, "GeometryPool", bytes);
+        } else {
+            GpuMemory::resize(memoryHandle, bytes);
+        }
+    }
+
+    void GeometryPool::setupVertexArrays() {
+        if (VAO == 0) {
+            glGenVertexArrays(1, &VAO);
+            glGenVertexArrays(1, &depthVAO);
+        }
+
+        glBindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+        glEnableVertexAttribArray(0);
+
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+        glEnableVertexAttribArray(1);
+
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+        glEnableVertexAttribArray(2);
+
+        glBindVertexArray(depthVAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    float GeometryPool::getFragmentation() const {
+        // Share of free space that is not in the largest block, worst of both buffers
+        float fragmentation = 0.0f;
+        for (const RangeAllocator* allocator : {&vertexAllocator, &indexAllocator}) {
+            size_t free = allocator->getFree();
+            if (free > 0) {
+                fragmentation = std::max(fragmentation, 1.0f - (float)allocator->getLargestFree() / (float)free);
+            }
+        }
+        return fragmentation;
+    }
+
+    size_t GeometryPool::getReclaimableBytes() const {
+        size_t vertexCapacity = vertexAllocator.getCapacity();
+        size_t indexCapacity = indexAllocator.getCapacity();
+        size_t vertexKept = std::max(initialVertices, vertexCapacity - vertexAllocator.getFree());
+        size_t indexKept = std::max(initialIndices, indexCapacity - indexAllocator.getFree());
+        size_t bytes = 0;
+        if (vertexCapacity > vertexKept) {
+            bytes += (vertexCapacity - vertexKept) * (sizeof(Vertex) + sizeof(glm::vec3));
+        }
+        if (indexCapacity > indexKept) {
+            bytes += (indexCapacity - indexKept) * sizeof(unsigned int);
+        }
+        return bytes;
+    }
+
+    GeometryPool::Stats GeometryPool::getStats() const {
+        Stats stats;
+        stats.allocations = allocations.size() - freeHandles.size();
+        stats.vertexCapacity = vertexAllocator.getCapacity();
+        stats.vertexUsed = stats.vertexCapacity - vertexAllocator.getFree();
+        stats.indexCapacity = indexAllocator.getCapacity();
+        stats.indexUsed = stats.indexCapacity - indexAllocator.getFree();
+        stats.freeBlocks = vertexAllocator.getBlockCount() + indexAllocator.getBlockCount();
+        stats.grows = growCount;
+        stats.defragmentations = defragmentCount;
+        return stats;
+    }
+
+    void GeometryPool::cleanup() {
+        if (VAO) {
+            glDeleteVertexArrays(1, &VAO);
+            VAO = 0;
+        }
+        if (depthVAO) {
+            glDeleteVertexArrays(1, &depthVAO);
+            depthVAO = 0;
+        }
+        if (VBO) {
+            glDeleteBuffers(1, &VBO);
+            VBO = 0;
+        }
+        if (positionVBO) {
+            glDeleteBuffers(1, &positionVBO);
+            positionVBO = 0;
+        }
+        if (EBO) {
+            glDeleteBuffers(1, &EBO);
+            EBO = 0;
+        }
+        GpuMemory::release(memoryHandle);
+        vertexAllocator.reset(0);
+        indexAllocator.reset(0);
+        allocations.clear();
+        freeHandles.clear();
+        generation++;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include <glengine/glStats.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <type_traits>
+
+namespace GLEngine {
+    namespace {
+        GLStats::Counters current;
+        GLStats::Counters frame;
+        GLStats::Counters maximum;
+        GLStats::Counters total;
+        uint64_t frameCount = 0;
+        bool installed = false;
+
+        template<typename Function>
+        void forEachCounter(GLStats::Counters& a, const GLStats::Counters& b, Function function) {
+            function(a.calls, b.calls);
+            function(a.drawCalls, b.drawCalls);
+            function(a.triangles, b.triangles);
+            function(a.stateChanges, b.stateChanges);
+            function(a.uniformUpdates, b.uniformUpdates);
+            function(a.bufferBytes, b.bufferBytes);
+            function(a.textureBytes, b.textureBytes);
+            function(a.errors, b.errors);
+        }
+    }
+
+#ifdef GLENGINE_GL_STATS
+    namespace {
+        enum class Category {
+            OTHER,
+            STATE,
+            UNIFORM
+        };
+
+        // Calls counted as state changes, glUniform* are matched by prefix
+        const char* STATE_FUNCTIONS[] = {
+            "glActiveTexture", "glBindBuffer", "glBindBufferBase", "glBindBufferRange", "glBindFramebuffer",
+            "glBindRenderbuffer", "glBindSampler", "glBindTexture", "glBindVertexArray", "glBlendColor",
+            "glBlendEquation", "glBlendEquationSeparate", "glBlendFunc", "glBlendFuncSeparate", "glClearColor",
+            "glClearDepth", "glClearStencil", "glColorMask", "glCullFace", "glDepthFunc", "glDepthMask",
+            "glDepthRange", "glDisable", "glDisablei", "glDisableVertexAttribArray", "glDrawBuffer", "glDrawBuffers",
+            "glEnable", "glEnablei", "glEnableVertexAttribArray", "glFrontFace", "glLineWidth", "glPixelStorei",
+            "glPointSize", "glPolygonMode", "glPolygonOffset", "glPrimitiveRestartIndex", "glReadBuffer",
+            "glScissor", "glStencilFunc", "glStencilFuncSeparate", "glStencilMask", "glStencilMaskSeparate",
+            "glStencilOp", "glStencilOpSeparate", "glTexParameterf", "glTexParameterfv", "glTexParameteri",
+            "glTexParameteriv", "glUseProgram", "glVertexAttribDivisor", "glVertexAttribIPointer",
+            "glVertexAttribPointer", "glViewport"
+        };
+
+        PFNGLGETERRORPROC getError = nullptr;
+
+        Category categorize(const char* name) {
+            if (std::strncmp(name, "glUniform", 9) == 0 && std::strcmp(name, "glUniformBlockBinding") != 0) {
+                return Category::UNIFORM;
+            }
+            for (const char* state : STATE_FUNCTIONS) {
+                if (std::strcmp(name, state) == 0) {
+                    return Category::STATE;
+                }
+            }
+            return Category::OTHER;
+        }
+
+        const char* getErrorName(GLenum error) {
+            switch (error) {
+                case GL_INVALID_ENUM: return "INVALID_ENUM";
+                case GL_INVALID_VALUE: return "INVALID_VALUE";
+                case GL_INVALID_OPERATION: return "INVALID_OPERATION";
+                case GL_INVALID_FRAMEBUFFER_OPERATION: return "INVALID_FRAMEBUFFER_OPERATION";
+                case GL_OUT_OF_MEMORY: return "OUT_OF_MEMORY";
+                default: return "UNKNOWN";
+            }
+        }
+
+        void checkErrors(const char* name) {
+#ifndef NDEBUG
+            // Bounded, a lost context can report errors forever
+            for (int i = 0; i < 8; i++) {
+                GLenum error = getError();
+                if (error == GL_NO_ERROR) {
+                    break;
+                }
+                current.errors++;
+                std::cerr << "ERROR::GL::" << getErrorName(error) << " after " << name << std::endl;
+            }
+#else
+            (void)name;
+#endif
+        }
+
+        uint64_t countTriangles(GLenum mode, GLsizei count) {
+            switch (mode) {
+                case GL_TRIANGLES: return (uint64_t)count / 3;
+                case GL_TRIANGLE_STRIP:
+                case GL_TRIANGLE_FAN: return count > 2 ? (uint64_t)count - 2 : 0;
+                case GL_TRIANGLES_ADJACENCY: return (uint64_t)count / 6;
+                case GL_TRIANGLE_STRIP_ADJACENCY: return count >= 6 ? ((uint64_t)count - 4) / 2 : 0;
+                default: return 0;
+            }
+        }
+
+        void countDraw(GLenum mode, GLsizei count, GLsizei instances = 1) {
+            current.drawCalls++;
+            current.triangles += countTriangles(mode, count) * (uint64_t)std::max(instances, 0);
+        }
+
+        void countMultiDraw(GLenum mode, const GLsizei* counts, GLsizei drawCount) {
+            for (GLsizei i = 0; counts && i < drawCount; i++) {
+                countDraw(mode, counts[i]);
+            }
+        }
+
+        size_t getPixelSize(GLenum format, GLenum type) {
+            size_t components = 4;
+            switch (format) {
+                case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX: components = 1; break;
+                case GL_RG: case GL_RG_INTEGER: components = 2; break;
+                case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: case GL_BGR_INTEGER: components = 3; break;
+                default: break;
+            }
+            switch (type) {
+                case GL_UNSIGNED_BYTE: case GL_BYTE: return components;
+                case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return components * 2;
+                case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: return components * 4;
+                case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1: return 2;
+                case GL_FLOAT_32_UNSIGNED_INT_24_8_REV: return 8;
+                default: return 4;
+            }
+        }
+
+        void countTexture(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels) {
+            // Null pixels only allocate; unpack alignment padding is ignored
+            if (pixels && width > 0 && height > 0 && depth > 0) {
+                current.textureBytes += (uint64_t)width * (uint64_t)height * (uint64_t)depth * getPixelSize(format, type);
+            }
+        }
+
+        // Counting that depends on the arguments, specialized for draws and uploads
+        template<auto* Slot>
+        struct Count {
+            template<typename... Args>
+            static void apply(const Args&...) {}
+        };
+
+        template<> struct Count<&glDrawArrays> {
+            static void apply(GLenum mode, GLint, GLsizei count) { countDraw(mode, count); }
+        };
+        template<> struct Count<&glDrawArraysInstanced> {
+            static void apply(GLenum mode, GLint, GLsizei count, GLsizei instances) { countDraw(mode, count, instances); }
+        };
+        template<> struct Count<&glDrawElements> {
+            static void apply(GLenum mode, GLsizei count, GLenum, const void*) { countDraw(mode, count); }
+        };
+        template<> struct Count<&glDrawElementsBaseVertex> {
+            static void apply(GLenum mode, GLsizei count, GLenum, const void*, GLint) { countDraw(mode, count); }
+        };
+        template<> struct Count<&glDrawRangeElements> {
+            static void apply(GLenum mode, GLuint, GLuint, GLsizei count, GLenum, const void*) { countDraw(mode, count); }
+        };
+        template<> struct Count<&glDrawRangeElementsBaseVertex> {
+            static void apply(GLenum mode, GLuint, GLuint, GLsizei count, GLenum, const void*, GLint) {
+                countDraw(mode, count);
+            }
+        };
+        template<> struct Count<&glDrawElementsInstanced> {
+            static void apply(GLenum mode, GLsizei count, GLenum, const void*, GLsizei instances) {
+                countDraw(mode, count, instances);
+            }
+        };
+        template<> struct Count<&glDrawElementsInstancedBaseVertex> {
+            static void apply(GLenum mode, GLsizei count, GLenum, const void*, GLsizei instances, GLint) {
+                countDraw(mode, count, instances);
+            }
+        };
+        template<> struct Count<&glMultiDrawArrays> {
+            static void apply(GLenum mode, const GLint*, const GLsizei* counts, GLsizei drawCount) {
+                countMultiDraw(mode, counts, drawCount);
+            }
+        };
+        template<> struct Count<&glMultiDrawElements> {
+            static void apply(GLenum mode, const GLsizei* counts, GLenum, const void* const*, GLsizei drawCount) {
+                countMultiDraw(mode, counts, drawCount);
+            }
+        };
+        template<> struct Count<&glMultiDrawElementsBaseVertex> {
+            static void apply(GLenum mode, const GLsizei* counts, GLenum, const void* const*, GLsizei drawCount,
+                              const GLint*) {
+                countMultiDraw(mode, counts, drawCount);
+            }
+        };
+
+        // Buffer uploads, mapped write ranges included since their content is sent too
+        template<> struct Count<&glBufferData> {
+            static void apply(GLenum, GLsizeiptr size, const void* data, GLenum) {
+                if (data) {
+                    current.bufferBytes += (uint64_t)size;
+                }
+            }
+        };
+        template<> struct Count<&glBufferSubData> {
+            static void apply(GLenum, GLintptr, GLsizeiptr size, const void*) { current.bufferBytes += (uint64_t)size; }
+        };
+        template<> struct Count<&glMapBufferRange> {
+            static void apply(GLenum, GLintptr, GLsizeiptr length, GLbitfield access) {
+                if (access & GL_MAP_WRITE_BIT) {
+                    current.bufferBytes += (uint64_t)length;
+                }
+            }
+        };
+
+        template<> struct Count<&glTexImage2D> {
+            static void apply(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type,
+                              const void* pixels) {
+                countTexture(width, height, 1, format, type, pixels);
+            }
+        };
+        template<> struct Count<&glTexSubImage2D> {
+            static void apply(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type,
+                              const void* pixels) {
+                countTexture(width, height, 1, format, type, pixels);
+            }
+        };
+        template<> struct Count<&glTexImage3D> {
+            static void apply(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLint, GLenum format,
+                              GLenum type, const void* pixels) {
+                countTexture(width, height, depth, format, type, pixels);
+            }
+        };
+        template<> struct Count<&glTexSubImage3D> {
+            static void apply(GLenum, GLint, GLint, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth,
+                              GLenum format, GLenum type, const void* pixels) {
+                countTexture(width, height, depth, format, type, pixels);
+            }
+        };
+        template<> struct Count<&glCompressedTexImage2D> {
+            static void apply(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei size, const void* data) {
+                if (data) {
+                    current.textureBytes += (uint64_t)size;
+                }
+            }
+        };
+
+        // One instantiation per glad entry point, the signature comes from the pointer type
+        template<auto* Slot, typename Pointer = std::remove_reference_t<decltype(*Slot)>>
+        struct Wrapper;
+
+        template<auto* Slot, typename Result, typename... Args>
+        struct Wrapper<Slot, Result (APIENTRYP)(Args...)> {
+            static inline Result (APIENTRYP original)(Args...) = nullptr;
+            static inline const char* name = "";
+            static inline Category category = Category::OTHER;
+
+            static Result APIENTRY call(Args... args) {
+                current.calls++;
+                if (category == Category::STATE) {
+                    current.stateChanges++;
+                } else if (category == Category::UNIFORM) {
+                    current.uniformUpdates++;
+                }
+                Count<Slot>::apply(args...);
+
+                // glGetError itself must keep returning the error to its caller
+                if constexpr (std::is_void<Result>::value) {
+                    original(args...);
+                    checkErrors(name);
+                } else if constexpr ((const void*)Slot == (const void*)&glGetError) {
+                    return original(args...);
+                } else {
+                    Result result = original(args...);
+                    checkErrors(name);
+                    return result;
+                }
+            }
+
+            static void install(const char* functionName) {
+                // Entry points the driver did not provide stay null
+                if (*Slot == nullptr || original != nullptr) {
+                    return;
+                }
+                original = *Slot;
+                name = functionName;
+                category = categorize(functionName);
+                *Slot = &call;
+            }
+        };
+    }
+
+    bool GLStats::install() {
+        if (installed) {
+            return true;
+        }
+        if (glad_glGetError == nullptr) {
+            std::cerr << "ERROR::GL_STATS::GL_NOT_LOADED" << std::endl;
+            return false;
+        }
+        getError = glad_glGetError;
+
+        // glFunctions.inl is generated from glad.h when GLENGINE_GL_STATS is ON
+#define GLENGINE_GL_FUNCTION(function) Wrapper<&function>::install(#function);
+#include <glengine/glFunctions.inl>
+#undef GLENGINE_GL_FUNCTION
+
+        installed = true;
+        return true;
+    }
+#else
+    bool GLStats::install() {
+        return false;
+    }
+#endif
+
+    bool GLStats::isEnabled() {
+        return installed;
+    }
+
+    void GLStats::endFrame() {
+        if (!installed) {
+            return;
+        }
+        frame = current;
+        forEachCounter(maximum, frame, [](uint64_t& a, uint64_t b) { a = std::max(a, b); });
+        forEachCounter(total, frame, [](uint64_t& a, uint64_t b) { a += b; });
+        frameCount++;
+        current = Counters();
+    }
+
+    const GLStats::Counters& GLStats::getFrame() {
+        return frame;
+    }
+
+    const GLStats::Counters& GLStats::getMax() {
+        return maximum;
+    }
+
+    const GLStats::Counters& GLStats::getTotal() {
+        return total;
+    }
+
+    uint64_t GLStats::getFrameCount() {
+        return frameCount;
+    }
+
+    void GLStats::writeJson(std::ostream& out) {
+        double frames = std::max<double>((double)frameCount, 1.0);
+        auto counter = [&](const char* name, uint64_t sum, uint64_t max) {
+            out << ",\"" << name << "\":{\"mean\":" << (double)sum / frames << ",\"max\":" << max << "}";
+        };
+
+        out << std::fixed << std::setprecision(3) << "{\"enabled\":" << (installed ? "true" : "false")
+            << ",\"frames\":" << frameCount;
+        counter("calls", total.calls, maximum.calls);
+        counter("draw_calls", total.drawCalls, maximum.drawCalls);
+        counter("triangles", total.triangles, maximum.triangles);
+        counter("state_changes", total.stateChanges, maximum.stateChanges);
+        counter("uniform_updates", total.uniformUpdates, maximum.uniformUpdates);
+        counter("buffer_bytes", total.bufferBytes, maximum.bufferBytes);
+        counter("texture_bytes", total.textureBytes, maximum.textureBytes);
+        counter("errors", total.errors, maximum.errors);
+        out << "}";
+    }
+}
\ No newline at end of file
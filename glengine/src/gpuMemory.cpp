@@ -0,0 +1,176 @@
+#include <glengine/gpuMemory.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace GLEngine {
+    namespace {
+        // Vendor extensions, not part of the generated loader; sizes are reported in KB
+        const GLenum GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX = 0x9048;
+        const GLenum GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX = 0x9049;
+        const GLenum TEXTURE_FREE_MEMORY_ATI = 0x87FC;
+
+        enum class DriverQuery {
+            UNKNOWN,
+            NONE,
+            NVX,
+            ATI
+        };
+
+        struct Slot {
+            GpuMemory::Resource resource;
+            bool live = false;
+        };
+
+        // Shared by the GL thread and the UI
+        std::mutex memoryMutex;
+        std::vector<Slot> slots;
+        std::vector<GpuMemory::Handle> freeHandles;
+        size_t totals[(size_t)GpuMemory::Category::COUNT] = {};
+        size_t total = 0;
+        size_t budget = 0;
+        DriverQuery driverQuery = DriverQuery::UNKNOWN;
+
+        bool hasExtension(const char* name) {
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (GLint i = 0; i < count; i++) {
+                const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+                if (extension && std::strcmp(extension, name) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    GpuMemory::Handle GpuMemory::track(Category category, const std::string& owner, size_t bytes) {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        Handle handle;
+        if (!freeHandles.empty()) {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        } else {
+            handle = (Handle)slots.size();
+            slots.emplace_back();
+        }
+        slots[handle] = { { category, owner, bytes }, true };
+        totals[(size_t)category] += bytes;
+        total += bytes;
+        return handle;
+    }
+
+    void GpuMemory::resize(Handle handle, size_t bytes) {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        if (handle >= slots.size() || !slots[handle].live) {
+            return;
+        }
+        Resource& resource = slots[handle].resource;
+        totals[(size_t)resource.category] += bytes - resource.bytes;
+        total += bytes - resource.bytes;
+        resource.bytes = bytes;
+    }
+
+    void GpuMemory::release(Handle& handle) {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        if (handle < slots.size() && slots[handle].live) {
+            Resource& resource = slots[handle].resource;
+            totals[(size_t)resource.category] -= resource.bytes;
+            total -= resource.bytes;
+            slots[handle].live = false;
+            freeHandles.push_back(handle);
+        }
+        handle = INVALID_HANDLE;
+    }
+
+    size_t GpuMemory::getTotal() {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        return total;
+    }
+
+    size_t GpuMemory::getTotal(Category category) {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        return totals[(size_t)category];
+    }
+
+    size_t GpuMemory::getResourceCount() {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        return slots.size() - freeHandles.size();
+    }
+
+    void GpuMemory::getResources(std::vector<Resource>& resources) {
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(memoryMutex);
+            for (const Slot& slot : slots) {
+                if (!slot.live) {
+                    continue;
+                }
+                if (count < resources.size()) {
+                    resources[count] = slot.resource;
+                } else {
+                    resources.push_back(slot.resource);
+                }
+                count++;
+            }
+        }
+        resources.resize(count);
+        std::sort(resources.begin(), resources.end(), [](const Resource& a, const Resource& b) {
+            return a.bytes > b.bytes;
+        });
+    }
+
+    const char* GpuMemory::getCategoryName(Category category) {
+        switch (category) {
+            case Category::GEOMETRY: return "Geometry";
+            case Category::TEXTURE: return "Textures";
+            case Category::RENDER_TARGET: return "Render targets";
+            case Category::STREAMING: return "Streaming";
+            case Category::READBACK: return "Readback";
+            default: return "Unknown";
+        }
+    }
+
+    void GpuMemory::setBudget(size_t bytes) {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        budget = bytes;
+    }
+
+    size_t GpuMemory::getBudget() {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        return budget;
+    }
+
+    bool GpuMemory::isOverBudget() {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        return budget > 0 && total > budget;
+    }
+
+    bool GpuMemory::queryDriver(DriverInfo& info) {
+        if (driverQuery == DriverQuery::UNKNOWN) {
+            driverQuery = hasExtension("GL_NVX_gpu_memory_info") ? DriverQuery::NVX :
+                hasExtension("GL_ATI_meminfo") ? DriverQuery::ATI : DriverQuery::NONE;
+        }
+
+        if (driverQuery == DriverQuery::NVX) {
+            GLint totalKB = 0, availableKB = 0;
+            glGetIntegerv(GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &totalKB);
+            glGetIntegerv(GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &availableKB);
+            info.source = "GL_NVX_gpu_memory_info";
+            info.totalBytes = (size_t)totalKB * 1024;
+            info.availableBytes = (size_t)availableKB * 1024;
+            return true;
+        }
+        if (driverQuery == DriverQuery::ATI) {
+            // Free pool memory, largest free block, free auxiliary memory, largest auxiliary block
+            GLint values[4] = {};
+            glGetIntegerv(TEXTURE_FREE_MEMORY_ATI, values);
+            info.source = "GL_ATI_meminfo";
+            info.totalBytes = 0;
+            info.availableBytes = (size_t)values[0] * 1024;
+            return true;
+        }
+        return false;
+    }
+}
\ No newline at end of file
@@ -2,7 +2,7 @@
 #include <glad/glad.h>
 
 namespace GLEngine {
-    Grid3D::Grid3D(float size, float spacing) {
+    Grid3D::Grid3D(float size, float spacing) : memoryHandle(GpuMemory::INVALID_HANDLE) {
         setupGrid(size, spacing);
         setupAxes(size);
 
@@ -23,6 +23,8 @@ namespace GLEngine {
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
+
+        memoryHandle = GpuMemory::track(GpuMemory::Category::GEOMETRY, "Grid3D", vertices.size() * sizeof(float));
     }
 
     Grid3D::~Grid3D() {
@@ -90,5 +92,6 @@ namespace GLEngine {
             glDeleteBuffers(1, &VBO);
             VBO = 0;
         }
+        GpuMemory::release(memoryHandle);
     }
 }
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include <glengine/jobSystem.hpp>
+#include <glengine/allocStats.hpp>
+#include <glengine/trace.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace GLEngine {
+    namespace {
+        // Workers of several systems can coexist, the index is only valid for its owner
+        thread_local const JobSystem* currentSystem = nullptr;
+        thread_local unsigned int currentThread = 0;
+
+        uint64_t nowNs() {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    JobSystem::JobSystem(unsigned int workerCount)
+    : queuedJobs(0), sleepingWorkers(0), stopping(false), traceHook(nullptr), traceUser(nullptr), executed(0), steals(0) {
+        if (workerCount == AUTO_WORKERS) {
+            // The GL thread runs jobs while it waits, so it counts as a core
+            workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        }
+        queues.reserve(workerCount + 1);
+        for (unsigned int i = 0; i <= workerCount; i++) {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+        workers.reserve(workerCount);
+        for (unsigned int i = 1; i <= workerCount; i++) {
+            workers.emplace_back(&JobSystem::workerLoop, this, i);
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        shutdown();
+    }
+
+    unsigned int JobSystem::getThreadIndex() const {
+        return currentSystem == this ? currentThread : 0;
+    }
+
+    void JobSystem::setTraceHook(TraceHook hook, void* user) {
+        traceUser.store(user, std::memory_order_relaxed);
+        traceHook.store(hook, std::memory_order_release);
+    }
+
+    void JobSystem::WorkQueue::pushBack(Job&& job) {
+        if (count == jobs.size()) {
+            // Unrolled in order into a twice larger ring
+            std::vector<Job> grown(std::max<size_t>(jobs.size() * 2, 64));
+            for (size_t i = 0; i < count; i++) {
+                grown[i] = std::move(jobs[(head + i) & (jobs.size() - 1)]);
+            }
+            jobs.swap(grown);
+            head = 0;
+        }
+        jobs[(head + count) & (jobs.size() - 1)] = std::move(job);
+        count++;
+    }
+
+    bool JobSystem::WorkQueue::popBack(Job& job) {
+        if (count == 0) {
+            return false;
+        }
+        count--;
+        Job& slot = jobs[(head + count) & (jobs.size() - 1)];
+        job = std::move(slot);
+        slot.function = nullptr;
+        return true;
+    }
+
+    bool JobSystem::WorkQueue::popFront(Job& job) {
+        if (count == 0) {
+            return false;
+        }
+        Job& slot = jobs[head];
+        job = std::move(slot);
+        slot.function = nullptr;
+        head = (head + 1) & (jobs.size() - 1);
+        count--;
+        return true;
+    }
+
+    void JobSystem::run(Counter& counter, std::function<void()> job, const char* name) {
+        Job entry;
+        entry.function = std::move(job);
+        entry.counter = &counter;
+        entry.name = name;
+        push(std::move(entry));
+    }
+
+    void JobSystem::push(Job&& job) {
+        job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+        // Counted before the push so a fast thief never takes it below zero
+        queuedJobs.fetch_add(1);
+
+        WorkQueue& queue = *queues[getThreadIndex()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.pushBack(std::move(job));
+        }
+
+        // Sleepers register before checking queuedJobs, so one side always sees the other
+        if (sleepingWorkers.load() > 0) {
+            { std::lock_guard<std::mutex> lock(sleepMutex); }
+            wake.notify_one();
+        }
+    }
+
+    bool JobSystem::pop(unsigned int thread, Job& job) {
+        // Own queue from the back, most recent and still in cache
+        {
+            WorkQueue& queue = *queues[thread];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.popBack(job)) {
+                queuedJobs.fetch_sub(1);
+                return true;
+            }
+        }
+
+        // Other queues from the front, oldest and usually the largest pieces of work
+        const size_t count = queues.size();
+        for (size_t i = 1; i < count; i++) {
+            WorkQueue& queue = *queues[(thread + i) % count];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.popFront(job)) {
+                queuedJobs.fetch_sub(1);
+                steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void JobSystem::execute(Job& job, unsigned int thread) {
+        TraceHook hook = traceHook.load(std::memory_order_acquire);
+        uint64_t start = hook ? nowNs() : 0;
+        if (job.range) {
+            job.range(job.body, job.first, job.last);
+        } else {
+            job.function();
+        }
+        if (hook) {
+            hook(job.name, thread, start, nowNs(), traceUser.load(std::memory_order_relaxed));
+        }
+        // Release the job's captures before the waiter can return
+        job.function = nullptr;
+        executed.fetch_add(1, std::memory_order_relaxed);
+        job.counter->pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    bool JobSystem::tryRunOne() {
+        unsigned int thread = getThreadIndex();
+        Job job;
+        if (!pop(thread, job)) {
+            return false;
+        }
+        execute(job, thread);
+        return true;
+    }
+
+    void JobSystem::wait(Counter& counter) {
+        // Never sleeps: runs queued jobs, and only yields while the last ones finish elsewhere
+        while (!counter.isDone()) {
+            if (!tryRunOne()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::parallelForRange(size_t count, const void* body, RangeFunction range, size_t minGrain,
+                                     const char* name) {
+        if (count == 0) {
+            return;
+        }
+        // A few chunks per thread leave room for stealing when chunks are uneven
+        size_t grain = std::max(count / (getThreadCount() * 4), std::max<size_t>(minGrain, 1));
+        if (workers.empty() || count <= grain) {
+            range(body, 0, count);
+            return;
+        }
+
+        Counter counter;
+        for (size_t first = grain; first < count; first += grain) {
+            Job job;
+            job.range = range;
+            job.body = body;
+            job.first = first;
+            job.last = std::min(first + grain, count);
+            job.counter = &counter;
+            job.name = name;
+            push(std::move(job));
+        }
+        // The caller takes the first chunk instead of idling
+        range(body, 0, grain);
+        wait(counter);
+    }
+
+    void JobSystem::shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            if (stopping) {
+                return;
+            }
+            stopping = true;
+        }
+        wake.notify_all();
+        // Queued jobs are still run before the workers exit
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        while (tryRunOne()) {}
+    }
+
+    void JobSystem::workerLoop(unsigned int thread) {
+        currentSystem = this;
+        currentThread = thread;
+        GLENGINE_TRACE_THREAD("Job Worker " + std::to_string(thread));
+        AllocStats::setThreadName("Job Worker");
+
+        for (;;) {
+            Job job;
+            if (pop(thread, job)) {
+                execute(job, thread);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepingWorkers.fetch_add(1);
+            wake.wait(lock, [this] { return stopping || queuedJobs.load() > 0; });
+            sleepingWorkers.fetch_sub(1);
+            if (stopping && queuedJobs.load() == 0) {
+                return;
+            }
+        }
+    }
+}
\ No newline at end of file
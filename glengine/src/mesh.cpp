@@ -1,10 +1,18 @@
 #include <glengine/mesh.hpp>
 #include <glengine/utils.hpp>
+#include <glengine/trace.hpp>
 #include <glad/glad.h>
+#include <atomic>
 #include <filesystem>
 
 namespace GLEngine {
-    Mesh::Mesh() : VAO(0), VBO(0), EBO(0), indexCount(0) {}
+    namespace {
+        std::atomic<uint32_t> nextMaterialId(1);
+    }
+
+    Mesh::Mesh() : VAO(0), VBO(0), EBO(0), normalsVAO(0), depthVAO(0), positionVBO(0), normalsStep(1),
+      memoryHandle(GpuMemory::INVALID_HANDLE), sourcePool(nullptr), resident(false), indexCount(0), vertexCount(0), revision(0),
+      pool(nullptr), poolHandle(GeometryPool::INVALID_HANDLE), normalsGeneration(0), boundsMin(0.0f), boundsMax(0.0f) {}
     
     Mesh::~Mesh() {
         cleanup();
@@ -26,13 +34,128 @@ namespace GLEngine {
         std::vector<Vertex> vertices;
         std::vector<unsigned int> indices;
         
-        loadObjFile(objPath.c_str(), vertices, indices, hasTexCoords);
-        setupBuffers(vertices, indices);
+        loadObjFile(objPath.c_str(), vertices, indices, subMeshes, materials, hasTexCoords);
+        assignMaterialIds();
+        computeBounds(vertices);
+        sourcePath = objPath;
+        uploadGeometry(vertices, indices);
+        revision++;
+    }
+
+    void Mesh::loadFromFile(const std::string& objPath, GeometryPool& geometryPool) {
+        cleanup();
+
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+
+        loadObjFile(objPath.c_str(), vertices, indices, subMeshes, materials, hasTexCoords);
+        assignMaterialIds();
+        computeBounds(vertices);
+        sourcePath = objPath;
+        sourcePool = &geometryPool;
+        uploadGeometry(vertices, indices);
+        revision++;
+    }
+
+    void Mesh::uploadGeometry(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+        if (!sourcePool) {
+            setupBuffers(vertices, indices);
+            memoryHandle = GpuMemory::track(GpuMemory::Category::GEOMETRY,
+                std::filesystem::path(sourcePath).filename().string(), getGeometryBytes());
+            resident = true;
+            return;
+        }
+
+        poolHandle = sourcePool->allocate(vertices, indices);
+        if (poolHandle != GeometryPool::INVALID_HANDLE) {
+            pool = sourcePool;
+            indexCount = indices.size();
+            vertexCount = vertices.size();
+            resident = true;
+
+            glGenVertexArrays(1, &normalsVAO);
+            setupNormalsAttributes(1);
+        }
+    }
+
+    size_t Mesh::getGeometryBytes() const {
+        // Interleaved vertices, the position-only stream and the indices
+        return vertexCount * (sizeof(Vertex) + sizeof(glm::vec3)) + indexCount * sizeof(unsigned int);
+    }
+
+    bool Mesh::evict() {
+        if (!resident || sourcePath.empty()) {
+            return false;
+        }
+        size_t keptIndexCount = indexCount;
+        size_t keptVertexCount = vertexCount;
+        releaseGeometry();
+        // Counts stay known so the budget can tell what a restore will cost
+        indexCount = keptIndexCount;
+        vertexCount = keptVertexCount;
+        return true;
+    }
+
+    bool Mesh::restore() {
+        if (resident) {
+            return true;
+        }
+        if (sourcePath.empty()) {
+            return false;
+        }
+        GLENGINE_TRACE_ZONE("Mesh::restore");
+
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        bool fileTexCoords = false;
+        loadObjFile(sourcePath.c_str(), vertices, indices, fileTexCoords);
+        return restore(vertices, indices);
+    }
+
+    bool Mesh::restore(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+        if (resident) {
+            return true;
+        }
+        // Sub-meshes and materials from the first load are kept, their ids are already in use;
+        // a file that changed since then would not match them
+        if (sourcePath.empty() || vertices.size() != vertexCount || indices.size() != indexCount) {
+            return false;
+        }
+        uploadGeometry(vertices, indices);
+        return resident;
+    }
+
+    void Mesh::assignMaterialIds() {
+        for (auto& material : materials) {
+            material.id = nextMaterialId++;
+        }
+    }
+
+    void Mesh::computeBounds(const std::vector<Vertex>& vertices) {
+        boundsMin = glm::vec3(0.0f);
+        boundsMax = glm::vec3(0.0f);
+        if (!vertices.empty()) {
+            boundsMin = boundsMax = vertices[0].position;
+            for (const auto& vertex : vertices) {
+                boundsMin = glm::min(boundsMin, vertex.position);
+                boundsMax = glm::max(boundsMax, vertex.position);
+            }
+        }
     }
     
+    void Mesh::loadTextures(TextureCache& textureCache) {
+        for (auto& material : materials) {
+            if (!material.diffuseMapPath.empty()) {
+                material.diffuseMap = textureCache.load(material.diffuseMapPath);
+            }
+        }
+    }
+
     void Mesh::setupBuffers(const std::vector<Vertex>& vertices,
                        const std::vector<unsigned int>& indices) {
+        GLENGINE_TRACE_ZONE("Mesh::setupBuffers");
         indexCount = indices.size();
+        vertexCount = vertices.size();
         
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
@@ -57,17 +180,117 @@ namespace GLEngine {
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
+
+        // Position-only stream for the depth pre-pass, sharing the index buffer
+        std::vector<glm::vec3> positions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            positions[i] = vertices[i].position;
+        }
+
+        glGenVertexArrays(1, &depthVAO);
+        glGenBuffers(1, &positionVBO);
+
+        glBindVertexArray(depthVAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        // Normals overlay: one instanced line per vertex, sourced from the same VBO
+        glGenVertexArrays(1, &normalsVAO);
+        setupNormalsAttributes(1);
+    }
+
+    void Mesh::setupNormalsAttributes(unsigned int step) {
+        GLsizei stride = step * sizeof(Vertex);
+        // Pooled vertices start at the mesh's range and move when the pool is compacted
+        size_t base = pool ? pool->getRange(poolHandle).vertexOffset * sizeof(Vertex) : 0;
+
+        glBindVertexArray(normalsVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, pool ? pool->getVertexBuffer() : VBO);
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(Vertex, position)));
+        glEnableVertexAttribArray(0);
+        glVertexAttribDivisor(0, 1);
+
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(Vertex, normal)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(1, 1);
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        normalsStep = step;
+        normalsGeneration = pool ? pool->getGeneration() : 0;
     }
     
     void Mesh::draw() const {
-        if (VAO != 0) {
-            glBindVertexArray(VAO);
-            glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+        unsigned int vao = getVAO();
+        if (vao != 0) {
+            glBindVertexArray(vao);
+            glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT,
+                (void*)(getFirstIndex() * sizeof(unsigned int)), getBaseVertex());
             glBindVertexArray(0);
         }
     }
     
+    void Mesh::drawDepthOnly() const {
+        unsigned int vao = pool ? pool->getDepthVAO() : depthVAO;
+        if (vao != 0) {
+            glBindVertexArray(vao);
+            glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT,
+                (void*)(getFirstIndex() * sizeof(unsigned int)), getBaseVertex());
+            glBindVertexArray(0);
+        }
+    }
+
+    void Mesh::drawNormals(unsigned int step) {
+        if (normalsVAO == 0 || vertexCount == 0) {
+            return;
+        }
+
+        if (step == 0) {
+            step = 1;
+        }
+        if (step != normalsStep || (pool && pool->getGeneration() != normalsGeneration)) {
+            setupNormalsAttributes(step);
+        }
+
+        // Instance i reads vertex i * step, so only every step-th normal is drawn
+        GLsizei instanceCount = (vertexCount + step - 1) / step;
+
+        glBindVertexArray(normalsVAO);
+        glDrawArraysInstanced(GL_LINES, 0, 2, instanceCount);
+        glBindVertexArray(0);
+    }
+    
     void Mesh::cleanup() {
+        releaseGeometry();
+        sourcePath.clear();
+        sourcePool = nullptr;
+        subMeshes.clear();
+        materials.clear();
+    }
+
+    void Mesh::releaseGeometry() {
+        if (normalsVAO) {
+            glDeleteVertexArrays(1, &normalsVAO);
+            normalsVAO = 0;
+        }
+        if (depthVAO) {
+            glDeleteVertexArrays(1, &depthVAO);
+            depthVAO = 0;
+        }
+        if (positionVBO) {
+            glDeleteBuffers(1, &positionVBO);
+            positionVBO = 0;
+        }
         if (VAO) {
             glDeleteVertexArrays(1, &VAO);
             VAO = 0;
@@ -80,6 +303,14 @@ namespace GLEngine {
             glDeleteBuffers(1, &EBO);
             EBO = 0;
         }
+        if (pool) {
+            pool->release(poolHandle);
+            pool = nullptr;
+            poolHandle = GeometryPool::INVALID_HANDLE;
+        }
+        GpuMemory::release(memoryHandle);
+        resident = false;
         indexCount = 0;
+        vertexCount = 0;
     }
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include <glengine/meshResidency.hpp>
+#include <glengine/gpuMemory.hpp>
+#include <glengine/trace.hpp>
+#include <glengine/utils.hpp>
+#include <algorithm>
+#include <iostream>
+
+namespace GLEngine {
+    MeshResidency::MeshResidency(GeometryPool& geometryPool)
+    : pool(geometryPool), frame(0), nextRequest(0), evictionCount(0), restoreCount(0), loader(1) {}
+
+    void MeshResidency::add(Mesh* mesh) {
+        if (indices.count(mesh)) {
+            return;
+        }
+        indices.emplace(mesh, entries.size());
+        entries.push_back({ mesh, frame, 0, false, false });
+    }
+
+    void MeshResidency::remove(Mesh* mesh) {
+        auto it = indices.find(mesh);
+        if (it == indices.end()) {
+            return;
+        }
+        // Swap with the last entry so indices stay dense
+        size_t index = it->second;
+        indices.erase(it);
+        if (index != entries.size() - 1) {
+            entries[index] = entries.back();
+            indices[entries[index].mesh] = index;
+        }
+        entries.pop_back();
+    }
+
+    void MeshResidency::clear() {
+        entries.clear();
+        indices.clear();
+    }
+
+    void MeshResidency::markVisible(const Mesh* mesh) {
+        auto it = indices.find(mesh);
+        if (it != indices.end()) {
+            entries[it->second].visible = true;
+        }
+    }
+
+    size_t MeshResidency::getEvictedCount() const {
+        return std::count_if(entries.begin(), entries.end(), [](const Entry& entry) {
+            return !entry.mesh->isResident();
+        });
+    }
+
+    bool MeshResidency::update() {
+        GLENGINE_TRACE_ZONE("MeshResidency::update");
+        bool changed = false;
+        frame++;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            uploads.swap(completed);
+        }
+        for (const auto& restored : uploads) {
+            // Results of a mesh removed while it was read are dropped
+            auto it = indices.find(restored->mesh);
+            if (it == indices.end() || entries[it->second].restoreRequest != restored->request) {
+                continue;
+            }
+            Entry& entry = entries[it->second];
+            entry.restoreRequest = 0;
+            if (entry.mesh->restore(restored->vertices, restored->indices)) {
+                restoreCount++;
+                changed = true;
+            } else {
+                // Not retried: the file no longer matches the first load, or the upload failed
+                entry.restoreFailed = true;
+                std::cerr << "ERROR::MESH_RESIDENCY::RESTORE_FAILED: " << entry.mesh->getSourcePath() << std::endl;
+            }
+        }
+        uploads.clear();
+
+        for (Entry& entry : entries) {
+            if (!entry.visible) {
+                continue;
+            }
+            entry.lastVisible = frame;
+            if (entry.mesh->isResident() || entry.restoreRequest != 0 || entry.restoreFailed ||
+                entry.mesh->getSourcePath().empty()) {
+                continue;
+            }
+            entry.restoreRequest = ++nextRequest;
+            loader.submit([this, mesh = entry.mesh, request = entry.restoreRequest, path = entry.mesh->getSourcePath()] {
+                auto restored = std::make_unique<Restored>();
+                restored->request = request;
+                restored->mesh = mesh;
+                bool hasTexCoords = false;
+                loadObjFile(path.c_str(), restored->vertices, restored->indices, hasTexCoords);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                completed.push_back(std::move(restored));
+            });
+        }
+
+        // Pool space freed by evictions only counts once the pool is shrunk
+        size_t budget = GpuMemory::getBudget();
+        if (budget > 0 && GpuMemory::getTotal() > budget) {
+            candidates.clear();
+            for (Entry& entry : entries) {
+                if (!entry.visible && entry.mesh->isResident()) {
+                    candidates.push_back(&entry);
+                }
+            }
+            std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b) {
+                return a->lastVisible < b->lastVisible;
+            });
+
+            bool evicted = false;
+            for (Entry* candidate : candidates) {
+                size_t reclaimable = pool.getReclaimableBytes();
+                size_t total = GpuMemory::getTotal();
+                if (total <= reclaimable || total - reclaimable <= budget) {
+                    break;
+                }
+                if (candidate->mesh->evict()) {
+                    evictionCount++;
+                    evicted = true;
+                }
+            }
+            if (pool.getReclaimableBytes() > 0) {
+                pool.defragment(true);
+                evicted = true;
+            }
+            changed = changed || evicted;
+        }
+
+        for (Entry& entry : entries) {
+            entry.visible = false;
+        }
+        return changed;
+    }
+}
\ No newline at end of file
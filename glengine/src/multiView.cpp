@@ -0,0 +1,128 @@
+#include <glengine/multiView.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace GLEngine {
+    MultiView::MultiView() : UBO(0), memoryHandle(GpuMemory::INVALID_HANDLE), blockStride(0), viewCount(0),
+      width(0), height(0), cameras(), rects(), depthPlanes() {}
+
+    MultiView::~MultiView() {
+        cleanup();
+    }
+
+    unsigned int MultiView::getViewCount(Layout layout) {
+        return layout == Layout::QUAD ? 4 : 1;
+    }
+
+    glm::ivec4 MultiView::getRect(Layout layout, unsigned int view, int width, int height) {
+        if (layout == Layout::SINGLE) {
+            return glm::ivec4(0, 0, width, height);
+        }
+        // Odd sizes give the extra pixel to the right column and the top row, the views tile without gaps
+        int halfWidth = width / 2;
+        int halfHeight = height / 2;
+        int column = view % 2;
+        int row = view / 2;
+        int x = column ? halfWidth : 0;
+        int y = row ? 0 : halfHeight;
+        return glm::ivec4(x, y, column ? width - halfWidth : halfWidth, row ? halfHeight : height - halfHeight);
+    }
+
+    void MultiView::beginFrame(Layout layout, const OrbitalCamera* const* _cameras, int _width, int _height) {
+        viewCount = std::min(getViewCount(layout), MAX_VIEWS);
+        width = _width;
+        height = _height;
+
+        if (UBO == 0) {
+            GLint alignment = 256;
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+            blockStride = (sizeof(CameraBlock) + alignment - 1) / alignment * alignment;
+            staging.assign(blockStride * MAX_VIEWS, 0);
+
+            glGenBuffers(1, &UBO);
+            glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+            glBufferData(GL_UNIFORM_BUFFER, staging.size(), nullptr, GL_STREAM_DRAW);
+            memoryHandle = GpuMemory::track(GpuMemory::Category::STREAMING, "MultiView", staging.size());
+        }
+
+        for (unsigned int v = 0; v < viewCount; v++) {
+            const OrbitalCamera& camera = *_cameras[v];
+            cameras[v] = &camera;
+            rects[v] = getRect(layout, v, width, height);
+
+            CameraBlock block;
+            block.view = camera.getViewMatrix();
+            block.projection = camera.getProjectionMatrix();
+            block.position = glm::vec4(camera.getPosition(), 1.0f);
+            std::memcpy(staging.data() + v * blockStride, &block, sizeof(block));
+
+            // Third row of the view matrix, negated and scaled so the depth is in [0, 1] up to the far plane
+            const glm::mat4& view = block.view;
+            depthPlanes[v] = -glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]) / camera.getFarPlane();
+
+            const Frustum& frustum = camera.getFrustum();
+            for (unsigned int p = 0; p < 6; p++) {
+                const glm::vec4& plane = frustum.planes[p];
+                unsigned int i = v * 6 + p;
+                planeX[i] = plane.x;
+                planeY[i] = plane.y;
+                planeZ[i] = plane.z;
+                planeW[i] = plane.w;
+                absX[i] = std::abs(plane.x);
+                absY[i] = std::abs(plane.y);
+                absZ[i] = std::abs(plane.z);
+            }
+        }
+
+        // Every view in one upload; the previous contents are orphaned rather than waited for
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, staging.size(), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, viewCount * blockStride, staging.data());
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void MultiView::bind(unsigned int view) const {
+        const glm::ivec4& rect = rects[view];
+        glViewport(rect.x, rect.y, rect.z, rect.w);
+        glScissor(rect.x, rect.y, rect.z, rect.w);
+        glEnable(GL_SCISSOR_TEST);
+        glBindBufferRange(GL_UNIFORM_BUFFER, CAMERA_BINDING, UBO, view * blockStride, sizeof(CameraBlock));
+    }
+
+    void MultiView::endFrame() const {
+        glDisable(GL_SCISSOR_TEST);
+        glViewport(0, 0, width, height);
+    }
+
+    uint32_t MultiView::cull(const glm::vec3& boxMin, const glm::vec3& boxMax) const {
+        glm::vec3 center = (boxMin + boxMax) * 0.5f;
+        glm::vec3 extents = (boxMax - boxMin) * 0.5f;
+
+        // Signed distance of the box corner furthest along each plane normal, for every view at once
+        const unsigned int planeCount = viewCount * 6;
+        float distances[MAX_PLANES];
+        for (unsigned int i = 0; i < planeCount; i++) {
+            distances[i] = planeX[i] * center.x + planeY[i] * center.y + planeZ[i] * center.z + planeW[i] +
+                absX[i] * extents.x + absY[i] * extents.y + absZ[i] * extents.z;
+        }
+
+        uint32_t mask = 0;
+        for (unsigned int v = 0; v < viewCount; v++) {
+            const float* view = distances + v * 6;
+            bool inside = view[0] >= 0.0f && view[1] >= 0.0f && view[2] >= 0.0f &&
+                          view[3] >= 0.0f && view[4] >= 0.0f && view[5] >= 0.0f;
+            mask |= (uint32_t)inside << v;
+        }
+        return mask;
+    }
+
+    void MultiView::cleanup() {
+        if (UBO) {
+            glDeleteBuffers(1, &UBO);
+            UBO = 0;
+        }
+        GpuMemory::release(memoryHandle);
+    }
+}
\ No newline at end of file
@@ -4,34 +4,174 @@
 #include <glm/gtx/rotate_vector.hpp>
 #include <glm/gtx/vector_angle.hpp>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 namespace GLEngine {
+	bool Frustum::intersects(const glm::vec3& boxMin, const glm::vec3& boxMax) const {
+		for (const glm::vec4& plane : planes) {
+			// Corner furthest along the plane normal
+			glm::vec3 corner(plane.x > 0.0f ? boxMax.x : boxMin.x,
+			                 plane.y > 0.0f ? boxMax.y : boxMin.y,
+			                 plane.z > 0.0f ? boxMax.z : boxMin.z);
+			if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
 	OrbitalCamera::OrbitalCamera(glm::vec3 _position, glm::vec3 _focus, glm::vec3 _up)
-	: position(_position), focus(_focus), up(_up), fov(45.0f), yaw(0.0f), pitch(0.0f) {
+	: position(_position), focus(_focus), up(_up), fov(45.0f), yaw(0.0f), pitch(0.0f),
+	  aspect(16.0f / 9.0f), nearPlane(0.1f), farPlane(100.0f), orthoHalfHeight(0.0f), pendingOrbit(0.0f),
+	  pendingDolly(0.0f), pendingTrack(0.0f), pendingPedestal(0.0f), pendingZoom(0.0f), view(1.0f), projection(1.0f),
+	  viewProjection(1.0f), frustum(), viewDirty(true), projectionDirty(true), viewProjectionDirty(true) {
 		updateCameraVectors();
 	}
 
-	glm::mat4 OrbitalCamera::getViewMatrix() {
-		return glm::lookAt(position, focus, up);
+	const glm::mat4& OrbitalCamera::getViewMatrix() const {
+		if (viewDirty) {
+			view = glm::lookAt(position, focus, up);
+			viewDirty = false;
+		}
+		return view;
+	}
+
+	const glm::mat4& OrbitalCamera::getProjectionMatrix() const {
+		if (projectionDirty) {
+			if (orthoHalfHeight > 0.0f) {
+				float halfWidth = orthoHalfHeight * aspect;
+				projection = glm::ortho(-halfWidth, halfWidth, -orthoHalfHeight, orthoHalfHeight, nearPlane, farPlane);
+			} else {
+				projection = glm::perspective(getFov(), aspect, nearPlane, farPlane);
+			}
+			projectionDirty = false;
+		}
+		return projection;
+	}
+
+	const glm::mat4& OrbitalCamera::getViewProjectionMatrix() const {
+		if (viewProjectionDirty) {
+			viewProjection = getProjectionMatrix() * getViewMatrix();
+
+			// Gribb-Hartmann: planes are sums and differences of the matrix rows
+			glm::mat4 m = glm::transpose(viewProjection);
+			frustum.planes[0] = m[3] + m[0];
+			frustum.planes[1] = m[3] - m[0];
+			frustum.planes[2] = m[3] + m[1];
+			frustum.planes[3] = m[3] - m[1];
+			frustum.planes[4] = m[3] + m[2];
+			frustum.planes[5] = m[3] - m[2];
+			for (glm::vec4& plane : frustum.planes)
+				plane /= glm::length(glm::vec3(plane));
+			viewProjectionDirty = false;
+		}
+		return viewProjection;
+	}
+
+	const Frustum& OrbitalCamera::getFrustum() const {
+		getViewProjectionMatrix();
+		return frustum;
 	}
 
 	glm::vec3 OrbitalCamera::getPosition() const {
 		return position;
 	}
 
+	glm::vec3 OrbitalCamera::getFocus() const {
+		return focus;
+	}
+
 	float OrbitalCamera::getFov() const {
 		return glm::radians(fov);
 	}
 
+	void OrbitalCamera::setLookAt(const glm::vec3& newPosition, const glm::vec3& newFocus) {
+		position = newPosition;
+		focus = newFocus;
+		pendingOrbit = glm::vec2(0.0f);
+		pendingDolly = pendingTrack = pendingPedestal = pendingZoom = 0.0f;
+		updateCameraVectors();
+		viewDirty = viewProjectionDirty = true;
+	}
+
 	void OrbitalCamera::orbit(float xoffset, float yoffset) {
+		pendingOrbit += glm::vec2(xoffset, yoffset);
+	}
+
+	void OrbitalCamera::dolly(float offset) {
+		pendingDolly += offset;
+	}
+
+	void OrbitalCamera::track(float offset) {
+		pendingTrack += offset;
+	}
+
+	void OrbitalCamera::pedestal(float offset) {
+		pendingPedestal += offset;
+	}
+
+	void OrbitalCamera::zoom(float offset) {
+		pendingZoom += offset;
+	}
+
+	bool OrbitalCamera::update() {
+		glm::vec3 previousPosition = position;
+		glm::vec3 previousFocus = focus;
+
+		if (pendingOrbit != glm::vec2(0.0f))
+			applyOrbit(pendingOrbit.x, pendingOrbit.y);
+		if (pendingTrack != 0.0f)
+			applyTrack(pendingTrack);
+		if (pendingPedestal != 0.0f)
+			applyPedestal(pendingPedestal);
+		if (pendingDolly != 0.0f)
+			applyDolly(pendingDolly);
+		if (pendingZoom != 0.0f)
+			applyZoom(pendingZoom);
+		pendingOrbit = glm::vec2(0.0f);
+		pendingDolly = pendingTrack = pendingPedestal = pendingZoom = 0.0f;
+
+		if (position == previousPosition && focus == previousFocus)
+			return false;
+		viewDirty = viewProjectionDirty = true;
+		return true;
+	}
+
+	void OrbitalCamera::setViewport(int width, int height) {
+		if (width <= 0 || height <= 0)
+			return;
+		float newAspect = (float)width / (float)height;
+		if (newAspect != aspect) {
+			aspect = newAspect;
+			projectionDirty = viewProjectionDirty = true;
+		}
+	}
+
+	void OrbitalCamera::setClipPlanes(float nearDistance, float farDistance) {
+		if (nearDistance != nearPlane || farDistance != farPlane) {
+			nearPlane = nearDistance;
+			farPlane = farDistance;
+			projectionDirty = viewProjectionDirty = true;
+		}
+	}
+
+	void OrbitalCamera::setOrthographic(float halfHeight) {
+		halfHeight = std::max(halfHeight, 0.0f);
+		if (halfHeight != orthoHalfHeight) {
+			orthoHalfHeight = halfHeight;
+			projectionDirty = viewProjectionDirty = true;
+		}
+	}
+
+	void OrbitalCamera::applyOrbit(float xoffset, float yoffset) {
 		const float epsilon = 0.1f;
 		xoffset *= 0.2f;
 		yoffset *= 0.2f;
 
 		float a = glm::degrees(glm::angle(glm::normalize(position - focus), up));
 
-		if (a + yoffset < epsilon || a + yoffset > 180 - epsilon)
-			yoffset = 0.0;
+		// Offsets summed over a frame may overshoot a pole: stop on it instead of dropping the motion
+		yoffset = glm::clamp(a + yoffset, epsilon, 180.0f - epsilon) - a;
 
 		yaw -= xoffset;
 		pitch -= yoffset;
@@ -41,19 +181,18 @@ namespace GLEngine {
 		pitch = 0.0;
 	}
 
-	void OrbitalCamera::dolly(float offset) {
+	void OrbitalCamera::applyDolly(float offset) {
 		const float epsilon = 0.005f;
 		offset *= 0.1f;
 
 		glm::vec3 cfv = focus - position;
-		if (glm::length(cfv) - offset < epsilon)
-			offset = 0.0f;
+		offset = std::min(offset, glm::length(cfv) - epsilon);
 
 		position = focus - (cfv - offset * glm::normalize(cfv));
 		updateCameraVectors();
 	}
 
-	void OrbitalCamera::track(float offset) {
+	void OrbitalCamera::applyTrack(float offset) {
 		offset *= 0.001f;
 
 		glm::vec3 dRight = offset * right;
@@ -62,7 +201,7 @@ namespace GLEngine {
 		updateCameraVectors();
 	}
 
-	void OrbitalCamera::pedestal(float offset) {
+	void OrbitalCamera::applyPedestal(float offset) {
 		offset *= 0.001f;
 
 		glm::vec3 dUp = offset * up;
@@ -71,15 +210,16 @@ namespace GLEngine {
 		updateCameraVectors();
 	}
 
-	void OrbitalCamera::zoom(float offset) {
+	void OrbitalCamera::applyZoom(float offset) {
+		const float epsilon = 0.005f;
 		glm::vec3 direction = glm::normalize(focus - position);
-        float distance = glm::length(focus - position);
-        
-        float zoomSpeed = distance * 0.1f;
-        
-        position -= direction * offset * zoomSpeed;
-        
-        updateCameraVectors();
+		float distance = glm::length(focus - position);
+
+		// Each step in keeps 90% of the distance, so any number of steps summed in one frame stays short of the focus
+		float newDistance = std::max(distance * std::pow(0.9f, -offset), epsilon);
+		position = focus - direction * newDistance;
+
+		updateCameraVectors();
 	}
 
 	void OrbitalCamera::updateCameraVectors() {
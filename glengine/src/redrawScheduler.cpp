@@ -0,0 +1,73 @@
+#include <glengine/redrawScheduler.hpp>
+#include <GLFW/glfw3.h>
+
+namespace GLEngine {
+    RedrawScheduler::RedrawScheduler(int settleFrames, double idleTimeout)
+    : settleFrames(settleFrames), idleTimeout(idleTimeout), enabled(false), animating(false),
+      pendingFrames(settleFrames), asyncSources(0), counts{}, framesRendered(0), framesSkipped(0) {}
+
+    void RedrawScheduler::setEnabled(bool _enabled) {
+        enabled = _enabled;
+        pendingFrames = settleFrames;
+    }
+
+    void RedrawScheduler::setAnimating(bool _animating) {
+        animating = _animating;
+    }
+
+    void RedrawScheduler::invalidate(Source source) {
+        counts[(size_t)source]++;
+        pendingFrames = settleFrames;
+    }
+
+    void RedrawScheduler::invalidateAsync(Source source) {
+        asyncSources.fetch_or(1u << (uint32_t)source, std::memory_order_release);
+        glfwPostEmptyEvent();
+    }
+
+    void RedrawScheduler::consumeAsync() {
+        uint32_t sources = asyncSources.exchange(0, std::memory_order_acquire);
+        for (size_t i = 0; i < (size_t)Source::COUNT; i++) {
+            if (sources & (1u << i)) {
+                invalidate((Source)i);
+            }
+        }
+    }
+
+    void RedrawScheduler::waitEvents() {
+        consumeAsync();
+        if (!enabled || animating || pendingFrames > 0) {
+            glfwPollEvents();
+        } else {
+            glfwWaitEventsTimeout(idleTimeout);
+        }
+        consumeAsync();
+    }
+
+    bool RedrawScheduler::beginFrame() {
+        if (enabled && !animating && pendingFrames <= 0) {
+            framesSkipped++;
+            return false;
+        }
+
+        if (animating) {
+            counts[(size_t)Source::ANIMATION]++;
+        }
+        if (pendingFrames > 0) {
+            pendingFrames--;
+        }
+        framesRendered++;
+        return true;
+    }
+
+    const char* RedrawScheduler::getSourceName(Source source) {
+        switch (source) {
+            case Source::INPUT: return "Input";
+            case Source::UI: return "UI";
+            case Source::RESIZE: return "Resize";
+            case Source::RESOURCE: return "Resource";
+            case Source::ANIMATION: return "Animation";
+            default: return "Unknown";
+        }
+    }
+}
\ No newline at end of file
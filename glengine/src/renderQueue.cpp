@@ -0,0 +1,238 @@
+#include <glengine/renderQueue.hpp>
+#include <glengine/trace.hpp>
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+
+namespace GLEngine {
+    namespace {
+        // Key layout, most significant first: pass 4 | shader 8 | material 16 | VAO 12 | depth 24
+        const int PASS_SHIFT = 60;
+        const int SHADER_SHIFT = 52;
+        const int MATERIAL_SHIFT = 36;
+        const int VAO_SHIFT = 24;
+        const uint32_t DEPTH_MAX = (1u << 24) - 1;
+
+        // Payload: recorder in the top 8 bits, command index below
+        const int RECORDER_SHIFT = 24;
+        const uint32_t COMMAND_MASK = (1u << RECORDER_SHIFT) - 1;
+
+        // LSD radix sort on bytes, stable; bytes shared by every key are skipped
+        void radixSort(std::pmr::vector<RenderQueue::Packet>& packets, std::pmr::vector<RenderQueue::Packet>& scratch) {
+            const size_t count = packets.size();
+            if (count < 2) {
+                return;
+            }
+            scratch.resize(count);
+
+            size_t histograms[8][256] = {};
+            for (const auto& packet : packets) {
+                for (int byte = 0; byte < 8; byte++) {
+                    histograms[byte][(packet.key >> (byte * 8)) & 0xFF]++;
+                }
+            }
+
+            RenderQueue::Packet* source = packets.data();
+            RenderQueue::Packet* destination = scratch.data();
+            for (int byte = 0; byte < 8; byte++) {
+                size_t* histogram = histograms[byte];
+                if (histogram[(source[0].key >> (byte * 8)) & 0xFF] == count) {
+                    continue;
+                }
+
+                size_t offset = 0;
+                for (int bucket = 0; bucket < 256; bucket++) {
+                    size_t bucketCount = histogram[bucket];
+                    histogram[bucket] = offset;
+                    offset += bucketCount;
+                }
+                for (size_t i = 0; i < count; i++) {
+                    destination[histogram[(source[i].key >> (byte * 8)) & 0xFF]++] = source[i];
+                }
+                std::swap(source, destination);
+            }
+
+            if (source != packets.data()) {
+                packets.swap(scratch);
+            }
+        }
+
+        bool keyLess(const RenderQueue::Packet& a, const RenderQueue::Packet& b) {
+            return a.key < b.key;
+        }
+    }
+
+    uint64_t RenderQueue::makeKey(unsigned int pass, unsigned int shader, unsigned int material, unsigned int vao, float depth) {
+        uint32_t quantized = (uint32_t)(std::min(std::max(depth, 0.0f), 1.0f) * (float)DEPTH_MAX);
+        return ((uint64_t)(pass & 0xF) << PASS_SHIFT) |
+               ((uint64_t)(shader & 0xFF) << SHADER_SHIFT) |
+               ((uint64_t)(material & 0xFFFF) << MATERIAL_SHIFT) |
+               ((uint64_t)(vao & 0xFFF) << VAO_SHIFT) |
+               (uint64_t)quantized;
+    }
+
+    RenderQueue::Recorder::Recorder(std::pmr::memory_resource* resource)
+    : packets(resource), scratch(resource), commands(resource) {}
+
+    void RenderQueue::Recorder::submit(uint64_t key, const RenderCommand& command) {
+        packets.push_back({ key, (index << RECORDER_SHIFT) | (uint32_t)commands.size() });
+        commands.push_back(command);
+    }
+
+    void RenderQueue::Recorder::submit(unsigned int pass, const Shader& shader, const Mesh& mesh, const glm::mat4& model,
+                                       const glm::mat3& normalMatrix, float depth) {
+        const std::vector<Material>& materials = mesh.getMaterials();
+        for (const SubMesh& subMesh : mesh.getSubMeshes()) {
+            const Material& material = materials[subMesh.material];
+
+            RenderCommand command;
+            command.shader = &shader;
+            command.material = &material;
+            command.vao = mesh.getVAO();
+            command.indexOffset = mesh.getFirstIndex() + subMesh.indexOffset;
+            command.indexCount = subMesh.indexCount;
+            command.baseVertex = mesh.getBaseVertex();
+            command.model = &model;
+            command.normalMatrix = &normalMatrix;
+            submit(makeKey(pass, shader.getId(), material.id, command.vao, depth), command);
+        }
+    }
+
+    RenderQueue::RenderQueue(unsigned int recorderCount, FrameArena* arena)
+    : arena(arena), sorted(getResource(0)), merged(getResource(0)) {
+        setRecorderCount(recorderCount);
+    }
+
+    std::pmr::memory_resource* RenderQueue::getResource(unsigned int recorder) const {
+        return arena && recorder < arena->getThreadCount() ? arena->getResource(recorder) : std::pmr::get_default_resource();
+    }
+
+    void RenderQueue::setRecorderCount(unsigned int count) {
+        count = std::min(std::max(count, 1u), 256u);
+        if (recorders.size() > count) {
+            recorders.erase(recorders.begin() + count, recorders.end());
+        }
+        while (recorders.size() < count) {
+            recorders.emplace_back(getResource((unsigned int)recorders.size()));
+            recorders.back().index = (uint32_t)recorders.size() - 1;
+        }
+    }
+
+    void RenderQueue::clear() {
+        for (auto& recorder : recorders) {
+            if (arena) {
+                FrameArena::recycle(recorder.packets);
+                FrameArena::recycle(recorder.scratch);
+                FrameArena::recycle(recorder.commands);
+            } else {
+                recorder.packets.clear();
+                recorder.commands.clear();
+            }
+        }
+        if (arena) {
+            FrameArena::recycle(sorted);
+            FrameArena::recycle(merged);
+        } else {
+            sorted.clear();
+        }
+        stats = Stats();
+    }
+
+    void RenderQueue::sort(JobSystem* jobs) {
+        GLENGINE_TRACE_ZONE("RenderQueue::sort");
+        auto start = std::chrono::steady_clock::now();
+
+        size_t used = 0;
+        for (const auto& recorder : recorders) {
+            used += recorder.packets.empty() ? 0 : 1;
+        }
+        if (jobs && used > 1) {
+            jobs->parallelFor(recorders.size(), [this](size_t first, size_t last) {
+                for (size_t i = first; i < last; i++) {
+                    radixSort(recorders[i].packets, recorders[i].scratch);
+                }
+            }, 1, "RenderQueue::sort");
+        } else {
+            for (auto& recorder : recorders) {
+                radixSort(recorder.packets, recorder.scratch);
+            }
+        }
+
+        // Stable merge: equal keys keep recorder order, then submission order
+        sorted.assign(recorders[0].packets.begin(), recorders[0].packets.end());
+        for (size_t i = 1; i < recorders.size(); i++) {
+            const std::pmr::vector<Packet>& packets = recorders[i].packets;
+            if (packets.empty()) {
+                continue;
+            }
+            merged.resize(sorted.size() + packets.size());
+            std::merge(sorted.begin(), sorted.end(), packets.begin(), packets.end(), merged.begin(), keyLess);
+            sorted.swap(merged);
+        }
+
+        stats.packets = sorted.size();
+        stats.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const RenderCommand& RenderQueue::getCommand(uint32_t payload) const {
+        return recorders[payload >> RECORDER_SHIFT].commands[payload & COMMAND_MASK];
+    }
+
+    void RenderQueue::execute(StateCache& state, unsigned int pass, const ShaderSetup& onShader, const MaterialSetup& onMaterial) {
+        GLENGINE_TRACE_ZONE("RenderQueue::execute");
+        // The pass is the top key field, so each pass is one contiguous range
+        Packet low = { (uint64_t)pass << PASS_SHIFT, 0 };
+        auto first = std::lower_bound(sorted.begin(), sorted.end(), low, keyLess);
+        auto last = sorted.end();
+        if (pass + 1 < MAX_PASSES) {
+            Packet high = { (uint64_t)(pass + 1) << PASS_SHIFT, 0 };
+            last = std::lower_bound(first, sorted.end(), high, keyLess);
+        }
+
+        // Code outside the queue binds programs and VAOs directly
+        state.invalidate();
+
+        const RenderCommand* current = nullptr;
+        for (auto it = first; it != last; ++it) {
+            const RenderCommand& command = getCommand(it->payload);
+
+            // Uniforms live in the program, a new shader needs its material and transform again
+            bool shaderChanged = state.useProgram(command.shader->getId());
+            if (shaderChanged) {
+                onShader(*command.shader);
+                stats.programBinds++;
+            }
+            if (shaderChanged || current->material != command.material) {
+                onMaterial(*command.shader, *command.material);
+                stats.materialChanges++;
+            }
+            if (state.bindVertexArray(command.vao)) {
+                stats.vaoBinds++;
+            }
+            if (command.model && (shaderChanged || current->model != command.model)) {
+                command.shader->setMat4("model", *command.model);
+                command.shader->setMat3("normalMatrix", *command.normalMatrix);
+                stats.transformChanges++;
+            }
+            current = &command;
+
+            // Neighbouring ranges with the same state go out as one draw
+            unsigned int count = command.indexCount;
+            while (it + 1 != last) {
+                const RenderCommand& next = getCommand((it + 1)->payload);
+                if (next.shader->getId() != command.shader->getId() || next.material != command.material ||
+                    next.vao != command.vao || next.baseVertex != command.baseVertex || next.model != command.model ||
+                    next.indexOffset != command.indexOffset + count) {
+                    break;
+                }
+                count += next.indexCount;
+                ++it;
+            }
+
+            glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT,
+                (void*)(command.indexOffset * sizeof(unsigned int)), command.baseVertex);
+            stats.drawCalls++;
+        }
+        state.bindVertexArray(0);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include <glengine/renderThread.hpp>
+#include <glengine/allocStats.hpp>
+#include <glengine/trace.hpp>
+#include <chrono>
+
+namespace GLEngine {
+    RenderThread::RenderThread()
+    : submitted(0), started(0), completed(0), stopping(false), sleepers(0), lastWaitMs(0.0) {}
+
+    RenderThread::~RenderThread() {
+        stop();
+    }
+
+    void RenderThread::start(Function onStart, Acquire onAcquire, Function onFrame, Function onStop) {
+        if (thread.joinable()) {
+            return;
+        }
+        stopping = false;
+        thread = std::thread(&RenderThread::loop, this, std::move(onStart), std::move(onAcquire),
+            std::move(onFrame), std::move(onStop));
+    }
+
+    void RenderThread::stop() {
+        if (!thread.joinable()) {
+            return;
+        }
+        stopping.store(true);
+        notify();
+        thread.join();
+    }
+
+    void RenderThread::submit() {
+        submitted.fetch_add(1);
+        notify();
+    }
+
+    void RenderThread::waitForPickup() {
+        waitFor(started);
+    }
+
+    void RenderThread::waitForIdle() {
+        waitFor(completed);
+    }
+
+    // The waiter counts itself before checking under the lock, so a change made after its check is never missed
+    void RenderThread::notify() {
+        if (sleepers.load() > 0) {
+            { std::lock_guard<std::mutex> lock(sleepMutex); }
+            wake.notify_all();
+        }
+    }
+
+    void RenderThread::waitFor(const std::atomic<uint64_t>& counter) {
+        uint64_t target = submitted.load(std::memory_order_relaxed);
+        if (counter.load() >= target || !thread.joinable()) {
+            lastWaitMs = 0.0;
+            return;
+        }
+        GLENGINE_TRACE_ZONE("RenderThread::wait");
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepers.fetch_add(1);
+            wake.wait(lock, [&] { return counter.load() >= target; });
+            sleepers.fetch_sub(1);
+        }
+        lastWaitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void RenderThread::loop(Function onStart, Acquire onAcquire, Function onFrame, Function onStop) {
+        GLENGINE_TRACE_THREAD("GL Thread");
+        AllocStats::setThreadName("GL Thread");
+        if (onStart) {
+            onStart();
+        }
+
+        for (;;) {
+            uint64_t frame = submitted.load();
+            if (started.load(std::memory_order_relaxed) == frame) {
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                sleepers.fetch_add(1);
+                wake.wait(lock, [&] { return stopping.load() || submitted.load() != started.load(std::memory_order_relaxed); });
+                sleepers.fetch_sub(1);
+                if (submitted.load() == started.load(std::memory_order_relaxed)) {
+                    break;
+                }
+                continue;
+            }
+
+            // The frame is taken before the main thread may publish over it. A submit racing the previous
+            // acquire may find its frame already taken, nothing new is drawn then
+            bool fresh = onAcquire();
+            started.store(frame);
+            notify();
+            if (fresh) {
+                onFrame();
+            }
+            completed.store(frame);
+            notify();
+        }
+
+        if (onStop) {
+            onStop();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include <glengine/scene.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+namespace GLEngine {
+    Scene::Scene() : firstDirty(INVALID_NODE), lastUpdateCount(0), revision(0) {}
+
+    Scene::NodeId Scene::createNode(NodeId parent, const glm::mat4& local) {
+        NodeId node = (NodeId)parents.size();
+        if (parent != INVALID_NODE && parent >= node) {
+            throw std::out_of_range("Scene::createNode: parent must exist before its children");
+        }
+
+        parents.push_back(parent);
+        localMatrices.push_back(local);
+        worldMatrices.push_back(glm::mat4(1.0f));
+        normalMatrices.push_back(glm::mat3(1.0f));
+        dirty.push_back(0);
+
+        markDirty(node);
+        return node;
+    }
+
+    void Scene::setLocalTransform(NodeId node, const glm::mat4& local) {
+        localMatrices[node] = local;
+        markDirty(node);
+    }
+
+    void Scene::clear() {
+        parents.clear();
+        localMatrices.clear();
+        worldMatrices.clear();
+        normalMatrices.clear();
+        dirty.clear();
+        firstDirty = INVALID_NODE;
+        revision++;
+    }
+
+    void Scene::markDirty(NodeId node) {
+        dirty[node] = 1;
+        firstDirty = std::min(firstDirty, node);
+    }
+
+    size_t Scene::update() {
+        lastUpdateCount = 0;
+        if (firstDirty == INVALID_NODE) {
+            return 0;
+        }
+
+        // Nodes before the first dirty one cannot be affected, and a child is
+        // always visited after its parent so dirtiness propagates in one pass.
+        const NodeId count = (NodeId)parents.size();
+        for (NodeId i = firstDirty; i < count; i++) {
+            NodeId parent = parents[i];
+            if (parent != INVALID_NODE && dirty[parent]) {
+                dirty[i] = 1;
+            }
+            if (!dirty[i]) {
+                continue;
+            }
+
+            worldMatrices[i] = parent == INVALID_NODE
+                ? localMatrices[i]
+                : worldMatrices[parent] * localMatrices[i];
+            normalMatrices[i] = glm::inverseTranspose(glm::mat3(worldMatrices[i]));
+            lastUpdateCount++;
+        }
+
+        // Flags are cleared in a second pass, children still need their parent's flag above
+        std::fill(dirty.begin() + firstDirty, dirty.end(), 0);
+        firstDirty = INVALID_NODE;
+        revision++;
+
+        return lastUpdateCount;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,363 @@
+#include <glengine/session.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+namespace GLEngine {
+    namespace {
+        const char MAGIC[4] = { 'G', 'L', 'S', 'N' };
+        const uint32_t VERSION = 1;
+
+        // Little-endian host layout, a session is replayed on the machine family it was recorded on
+        enum Event : uint8_t {
+            EVENT_FRAME = 1,        // f64 clock
+            EVENT_CAMERA = 2,       // u8 input, f32 x, f32 y
+            EVENT_PARAMETER = 3,    // u16 index, raw value
+            EVENT_CAMERA_STATE = 4  // f32 position[3], f32 focus[3]
+        };
+
+        void applyCameraInput(OrbitalCamera& camera, Session::CameraInput input, float x, float y) {
+            switch (input) {
+                case Session::CameraInput::ORBIT:
+                    camera.orbit(x, y);
+                    break;
+                case Session::CameraInput::TRACK:
+                    camera.track(x);
+                    break;
+                case Session::CameraInput::PEDESTAL:
+                    camera.pedestal(x);
+                    break;
+                case Session::CameraInput::DOLLY:
+                    camera.dolly(x);
+                    break;
+                case Session::CameraInput::ZOOM:
+                    camera.zoom(x);
+                    break;
+            }
+        }
+
+        double percentile(std::vector<double> values, double fraction) {
+            if (values.empty()) {
+                return 0.0;
+            }
+            size_t index = std::min(values.size() - 1, (size_t)(fraction * (double)(values.size() - 1) + 0.5));
+            std::nth_element(values.begin(), values.begin() + index, values.end());
+            return values[index];
+        }
+    }
+
+    Session::Session() : mode(Mode::IDLE), width(0), height(0), frameCount(0), bytesWritten(0), parameterChanges(0), frameTime(0.0) {}
+
+    Session::~Session() {
+        stop();
+    }
+
+    void Session::addParameter(const std::string& name, size_t size, std::function<void(void*)> read,
+                               std::function<void(const void*)> write) {
+        // The header lists the parameters, they cannot change once a session is open
+        if (mode != Mode::IDLE) {
+            std::cerr << "ERROR::SESSION::BIND_WHILE_ACTIVE: " << name << std::endl;
+            return;
+        }
+        parameters.push_back({ name, size, std::move(read), std::move(write), std::vector<unsigned char>(size) });
+    }
+
+    void Session::writeBytes(const void* data, size_t size) {
+        output.write((const char*)data, size);
+        bytesWritten += size;
+    }
+
+    bool Session::readBytes(void* data, size_t size) {
+        input.read((char*)data, size);
+        return (size_t)input.gcount() == size;
+    }
+
+    bool Session::startRecording(const std::string& path, const OrbitalCamera& camera, int width, int height) {
+        stop();
+
+        std::error_code error;
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty()) {
+            std::filesystem::create_directories(parent, error);
+        }
+        output.open(path, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            std::cerr << "ERROR::SESSION::OPEN_FAILED: " << path << std::endl;
+            return false;
+        }
+
+        mode = Mode::RECORDING;
+        this->width = width;
+        this->height = height;
+        frameCount = 0;
+        bytesWritten = 0;
+        timings.clear();
+
+        uint32_t count = (uint32_t)parameters.size();
+        writeBytes(MAGIC, sizeof(MAGIC));
+        writeBytes(&VERSION, sizeof(VERSION));
+        writeBytes(&width, sizeof(width));
+        writeBytes(&height, sizeof(height));
+        writeBytes(&count, sizeof(count));
+        for (const Parameter& parameter : parameters) {
+            uint8_t length = (uint8_t)std::min<size_t>(parameter.name.size(), 255);
+            uint32_t size = (uint32_t)parameter.size;
+            writeBytes(&length, sizeof(length));
+            writeBytes(parameter.name.data(), length);
+            writeBytes(&size, sizeof(size));
+        }
+
+        // Starting state, so a replay does not depend on the defaults of the build replaying it
+        uint8_t event = EVENT_CAMERA_STATE;
+        float state[6];
+        glm::vec3 position = camera.getPosition();
+        glm::vec3 focus = camera.getFocus();
+        std::memcpy(state, &position[0], sizeof(float) * 3);
+        std::memcpy(state + 3, &focus[0], sizeof(float) * 3);
+        writeBytes(&event, sizeof(event));
+        writeBytes(state, sizeof(state));
+        writeChangedParameters(true);
+        return true;
+    }
+
+    bool Session::startReplay(const std::string& path) {
+        stop();
+
+        input.open(path, std::ios::binary);
+        if (!input) {
+            std::cerr << "ERROR::SESSION::OPEN_FAILED: " << path << std::endl;
+            return false;
+        }
+
+        char magic[4];
+        uint32_t version = 0, count = 0;
+        if (!readBytes(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            !readBytes(&version, sizeof(version)) || version != VERSION ||
+            !readBytes(&width, sizeof(width)) || !readBytes(&height, sizeof(height)) ||
+            !readBytes(&count, sizeof(count))) {
+            std::cerr << "ERROR::SESSION::INVALID_FILE: " << path << std::endl;
+            input.close();
+            return false;
+        }
+
+        fileParameters.clear();
+        for (uint32_t i = 0; i < count; i++) {
+            uint8_t length = 0;
+            uint32_t size = 0;
+            std::string name;
+            if (!readBytes(&length, sizeof(length))) {
+                break;
+            }
+            name.resize(length);
+            if (!readBytes(&name[0], length) || !readBytes(&size, sizeof(size))) {
+                break;
+            }
+
+            // Parameters this build does not have, or with another layout, are skipped
+            FileParameter parameter = { -1, size };
+            for (size_t j = 0; j < parameters.size(); j++) {
+                if (parameters[j].name == name && parameters[j].size == size) {
+                    parameter.bound = (int)j;
+                    break;
+                }
+            }
+            if (parameter.bound < 0) {
+                std::cerr << "WARNING::SESSION::UNKNOWN_PARAMETER: " << name << std::endl;
+            }
+            fileParameters.push_back(parameter);
+        }
+        if (fileParameters.size() != count) {
+            std::cerr << "ERROR::SESSION::INVALID_FILE: " << path << std::endl;
+            input.close();
+            return false;
+        }
+
+        mode = Mode::REPLAYING;
+        frameCount = 0;
+        timings.clear();
+        return true;
+    }
+
+    void Session::stop() {
+        if (output.is_open()) {
+            output.close();
+        }
+        if (input.is_open()) {
+            input.close();
+        }
+        mode = Mode::IDLE;
+    }
+
+    void Session::cameraInput(OrbitalCamera& camera, CameraInput input, float x, float y) {
+        if (mode == Mode::REPLAYING) {
+            return;
+        }
+        applyCameraInput(camera, input, x, y);
+
+        if (mode == Mode::RECORDING) {
+            uint8_t event = EVENT_CAMERA;
+            uint8_t type = (uint8_t)input;
+            writeBytes(&event, sizeof(event));
+            writeBytes(&type, sizeof(type));
+            writeBytes(&x, sizeof(x));
+            writeBytes(&y, sizeof(y));
+        }
+    }
+
+    void Session::writeParameter(uint16_t index) {
+        uint8_t event = EVENT_PARAMETER;
+        writeBytes(&event, sizeof(event));
+        writeBytes(&index, sizeof(index));
+        writeBytes(parameters[index].recorded.data(), parameters[index].size);
+    }
+
+    void Session::writeChangedParameters(bool all) {
+        for (size_t i = 0; i < parameters.size() && i <= 0xFFFF; i++) {
+            Parameter& parameter = parameters[i];
+            scratch.resize(parameter.size);
+            parameter.read(scratch.data());
+            if (all || std::memcmp(scratch.data(), parameter.recorded.data(), parameter.size) != 0) {
+                std::memcpy(parameter.recorded.data(), scratch.data(), parameter.size);
+                writeParameter((uint16_t)i);
+                parameterChanges++;
+            }
+        }
+    }
+
+    bool Session::beginFrame(OrbitalCamera& camera, double& time) {
+        if (mode == Mode::RECORDING) {
+            uint8_t event = EVENT_FRAME;
+            writeBytes(&event, sizeof(event));
+            writeBytes(&time, sizeof(time));
+            frameTime = time;
+            frameCount++;
+            return true;
+        }
+        if (mode != Mode::REPLAYING) {
+            return true;
+        }
+
+        // Everything recorded between the previous frame and this one
+        for (;;) {
+            uint8_t event = 0;
+            if (!readBytes(&event, sizeof(event))) {
+                break;
+            }
+
+            if (event == EVENT_FRAME) {
+                if (!readBytes(&frameTime, sizeof(frameTime))) {
+                    break;
+                }
+                time = frameTime;
+                frameCount++;
+                return true;
+            } else if (event == EVENT_CAMERA) {
+                uint8_t type = 0;
+                float x = 0.0f, y = 0.0f;
+                if (!readBytes(&type, sizeof(type)) || !readBytes(&x, sizeof(x)) || !readBytes(&y, sizeof(y))) {
+                    break;
+                }
+                applyCameraInput(camera, (CameraInput)type, x, y);
+            } else if (event == EVENT_PARAMETER) {
+                uint16_t index = 0;
+                if (!readBytes(&index, sizeof(index)) || index >= fileParameters.size()) {
+                    break;
+                }
+                const FileParameter& parameter = fileParameters[index];
+                scratch.resize(parameter.size);
+                if (!readBytes(scratch.data(), parameter.size)) {
+                    break;
+                }
+                if (parameter.bound >= 0) {
+                    parameters[parameter.bound].write(scratch.data());
+                    parameterChanges++;
+                }
+            } else if (event == EVENT_CAMERA_STATE) {
+                float state[6];
+                if (!readBytes(state, sizeof(state))) {
+                    break;
+                }
+                camera.setLookAt(glm::vec3(state[0], state[1], state[2]), glm::vec3(state[3], state[4], state[5]));
+            } else {
+                std::cerr << "ERROR::SESSION::INVALID_EVENT: " << (int)event << std::endl;
+                break;
+            }
+        }
+
+        // End of the file, or a truncated last frame
+        stop();
+        return false;
+    }
+
+    void Session::endFrame(double cpuMs, double gpuMs) {
+        if (mode == Mode::IDLE) {
+            return;
+        }
+        // Changes made by this frame's UI take effect from the next frame on
+        if (mode == Mode::RECORDING) {
+            writeChangedParameters(false);
+        }
+        // A recording started from the UI begins with the next frame
+        if (frameCount == 0) {
+            return;
+        }
+        timings.push_back({ frameTime, cpuMs, gpuMs });
+    }
+
+    bool Session::writeTimings(const std::string& path) const {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            std::cerr << "ERROR::SESSION::OPEN_FAILED: " << path << std::endl;
+            return false;
+        }
+        file << "frame,time,cpu_ms,gpu_ms\n" << std::fixed << std::setprecision(4);
+        for (size_t i = 0; i < timings.size(); i++) {
+            file << i << ',' << timings[i].time << ',' << timings[i].cpuMs << ',' << timings[i].gpuMs << '\n';
+        }
+        return (bool)file;
+    }
+
+    void Session::getSummary(std::vector<double>& cpu, std::vector<double>& gpu, double& cpuMean,
+                             double& gpuMean) const {
+        double cpuTotal = 0.0, gpuTotal = 0.0;
+        for (const FrameTiming& timing : timings) {
+            cpu.push_back(timing.cpuMs);
+            gpu.push_back(timing.gpuMs);
+            cpuTotal += timing.cpuMs;
+            gpuTotal += timing.gpuMs;
+        }
+        double count = std::max<double>((double)timings.size(), 1.0);
+        cpuMean = cpuTotal / count;
+        gpuMean = gpuTotal / count;
+    }
+
+    void Session::printSummary(std::ostream& out) const {
+        std::vector<double> cpu, gpu;
+        double cpuMean = 0.0, gpuMean = 0.0;
+        getSummary(cpu, gpu, cpuMean, gpuMean);
+
+        out << std::fixed << std::setprecision(3)
+            << "frames: " << timings.size() << "\n"
+            << "cpu ms: mean " << cpuMean << ", p50 " << percentile(cpu, 0.5) << ", p95 " << percentile(cpu, 0.95)
+            << ", p99 " << percentile(cpu, 0.99) << ", max " << percentile(cpu, 1.0) << "\n"
+            << "gpu ms: mean " << gpuMean << ", p50 " << percentile(gpu, 0.5) << ", p95 " << percentile(gpu, 0.95)
+            << ", p99 " << percentile(gpu, 0.99) << ", max " << percentile(gpu, 1.0) << std::endl;
+    }
+
+    void Session::writeSummaryJson(std::ostream& out) const {
+        std::vector<double> cpu, gpu;
+        double cpuMean = 0.0, gpuMean = 0.0;
+        getSummary(cpu, gpu, cpuMean, gpuMean);
+
+        auto series = [&](const char* name, const std::vector<double>& values, double mean) {
+            out << ",\"" << name << "\":{\"mean\":" << mean << ",\"p50\":" << percentile(values, 0.5)
+                << ",\"p95\":" << percentile(values, 0.95) << ",\"p99\":" << percentile(values, 0.99)
+                << ",\"max\":" << percentile(values, 1.0) << "}";
+        };
+        out << std::fixed << std::setprecision(3) << "{\"frames\":" << timings.size();
+        series("cpu_ms", cpu, cpuMean);
+        series("gpu_ms", gpu, gpuMean);
+        out << "}";
+    }
+}
\ No newline at end of file
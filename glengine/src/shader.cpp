@@ -1,10 +1,12 @@
 #include <glengine/shader.hpp>
 #include <glengine/utils.hpp>
+#include <glengine/trace.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 
 namespace GLEngine {
     Shader::Shader(const char* vertexPath, const char* fragmentPath) {
+        GLENGINE_TRACE_ZONE("Shader::compile");
         std::string vertexCode = readFile(vertexPath);
         std::string fragmentCode = readFile(fragmentPath);
 
@@ -34,6 +36,7 @@ namespace GLEngine {
     }
 
     Shader::Shader(const char* vertexPath, const char* geometryPath, const char* fragmentPath) {
+        GLENGINE_TRACE_ZONE("Shader::compile");
         std::string vertexCode = readFile(vertexPath);
         std::string geometryCode = readFile(geometryPath);
         std::string fragmentCode = readFile(fragmentPath);
@@ -79,24 +82,47 @@ namespace GLEngine {
         glUseProgram(id);
     }
 
-    void Shader::setBool(const std::string &name, bool value) const {
-        glUniform1i(glGetUniformLocation(id, name.c_str()), (int)value);
+    void Shader::setBool(const char* name, bool value) const {
+        glUniform1i(glGetUniformLocation(id, name), (int)value);
     }
     
-    void Shader::setInt(const std::string &name, int value) const {
-        glUniform1i(glGetUniformLocation(id, name.c_str()), value);
+    void Shader::setInt(const char* name, int value) const {
+        glUniform1i(glGetUniformLocation(id, name), value);
     }
     
-    void Shader::setFloat(const std::string &name, float value) const {
-        glUniform1f(glGetUniformLocation(id, name.c_str()), value);
+    void Shader::setFloat(const char* name, float value) const {
+        glUniform1f(glGetUniformLocation(id, name), value);
     }
 
-    void Shader::setVec3(const std::string &name, const glm::vec3 &value) const {
-        glUniform3fv(glGetUniformLocation(id, name.c_str()), 1, &value[0]);
+    void Shader::setVec2(const char* name, const glm::vec2 &value) const {
+        glUniform2fv(glGetUniformLocation(id, name), 1, &value[0]);
     }
 
-    void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const {
-        glUniformMatrix4fv(glGetUniformLocation(id, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    void Shader::setIVec3(const char* name, const glm::ivec3 &value) const {
+        glUniform3iv(glGetUniformLocation(id, name), 1, &value[0]);
+    }
+
+    void Shader::setVec3(const char* name, const glm::vec3 &value) const {
+        glUniform3fv(glGetUniformLocation(id, name), 1, &value[0]);
+    }
+
+    void Shader::setVec4(const char* name, const glm::vec4 &value) const {
+        glUniform4fv(glGetUniformLocation(id, name), 1, &value[0]);
+    }
+
+    void Shader::setMat3(const char* name, const glm::mat3 &mat) const {
+        glUniformMatrix3fv(glGetUniformLocation(id, name), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+    void Shader::setMat4(const char* name, const glm::mat4 &mat) const {
+        glUniformMatrix4fv(glGetUniformLocation(id, name), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
+    void Shader::bindUniformBlock(const char* name, unsigned int binding) const {
+        unsigned int index = glGetUniformBlockIndex(id, name);
+        if (index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(id, index, binding);
+        }
     }
 
     void Shader::checkCompileErrors(unsigned int shader, std::string type) {
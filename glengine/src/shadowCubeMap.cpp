@@ -0,0 +1,118 @@
+#include <glengine/shadowCubeMap.hpp>
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace GLEngine {
+    ShadowCubeMap::ShadowCubeMap(int size, float nearPlane, float farPlane)
+    : FBO(0), texture(0), memoryHandle(GpuMemory::INVALID_HANDLE), size(size), nearPlane(nearPlane), farPlane(farPlane),
+      valid(false), renderedRevision(0), renderCount(0) {}
+
+    ShadowCubeMap::~ShadowCubeMap() {
+        cleanup();
+    }
+
+    void ShadowCubeMap::setup() {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+        for (int face = 0; face < 6; face++) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_DEPTH_COMPONENT24, size, size, 0,
+                GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+        }
+        // Linear filtering with depth comparison gives hardware 2x2 PCF in a single fetch
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+        glGenFramebuffers(1, &FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        // Six DEPTH_COMPONENT24 faces, stored as 32 bits per texel
+        memoryHandle = GpuMemory::track(GpuMemory::Category::RENDER_TARGET, "ShadowCubeMap", (size_t)size * size * 4 * 6);
+    }
+
+    bool ShadowCubeMap::needsUpdate(uint64_t revision) const {
+        return !valid || revision != renderedRevision;
+    }
+
+    void ShadowCubeMap::render(const glm::vec3& lightPos, uint64_t revision,
+                               const std::function<void(const glm::mat4& lightViewProjection)>& drawScene) {
+        if (!needsUpdate(revision)) {
+            return;
+        }
+        if (FBO == 0) {
+            setup();
+        }
+
+        static const glm::vec3 directions[6] = {
+            { 1.0f,  0.0f,  0.0f}, {-1.0f,  0.0f,  0.0f},
+            { 0.0f,  1.0f,  0.0f}, { 0.0f, -1.0f,  0.0f},
+            { 0.0f,  0.0f,  1.0f}, { 0.0f,  0.0f, -1.0f}
+        };
+        static const glm::vec3 ups[6] = {
+            {0.0f, -1.0f,  0.0f}, {0.0f, -1.0f,  0.0f},
+            {0.0f,  0.0f,  1.0f}, {0.0f,  0.0f, -1.0f},
+            {0.0f, -1.0f,  0.0f}, {0.0f, -1.0f,  0.0f}
+        };
+        glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
+
+        GLint previousViewport[4];
+        glGetIntegerv(GL_VIEWPORT, previousViewport);
+        GLint previousFramebuffer = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glViewport(0, 0, size, size);
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_TRUE);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 4.0f);
+
+        for (int face = 0; face < 6; face++) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, texture, 0);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            drawScene(projection * glm::lookAt(lightPos, lightPos + directions[face], ups[face]));
+        }
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+        glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+
+        valid = true;
+        renderedRevision = revision;
+        renderCount++;
+    }
+
+    void ShadowCubeMap::bind(int textureUnit) const {
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void ShadowCubeMap::setSize(int _size) {
+        if (_size != size) {
+            cleanup();
+            size = _size;
+        }
+    }
+
+    void ShadowCubeMap::cleanup() {
+        if (FBO) {
+            glDeleteFramebuffers(1, &FBO);
+            FBO = 0;
+        }
+        if (texture) {
+            glDeleteTextures(1, &texture);
+            texture = 0;
+        }
+        GpuMemory::release(memoryHandle);
+        valid = false;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include <glengine/stateCache.hpp>
+#include <glad/glad.h>
+
+namespace GLEngine {
+    namespace {
+        // Never a valid GL name, so the first bind after invalidate() always goes through
+        const unsigned int UNKNOWN = 0xFFFFFFFFu;
+    }
+
+    StateCache::StateCache() : program(UNKNOWN), vao(UNKNOWN), issued(0), skipped(0) {}
+
+    bool StateCache::useProgram(unsigned int newProgram) {
+        if (newProgram == program) {
+            skipped++;
+            return false;
+        }
+        glUseProgram(newProgram);
+        program = newProgram;
+        issued++;
+        return true;
+    }
+
+    bool StateCache::bindVertexArray(unsigned int newVao) {
+        if (newVao == vao) {
+            skipped++;
+            return false;
+        }
+        glBindVertexArray(newVao);
+        vao = newVao;
+        issued++;
+        return true;
+    }
+
+    void StateCache::invalidate() {
+        program = UNKNOWN;
+        vao = UNKNOWN;
+    }
+}
\ No newline at end of file
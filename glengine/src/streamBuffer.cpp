@@ -0,0 +1,222 @@
+#include <glengine/streamBuffer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace GLEngine {
+    namespace {
+        typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+        BufferStorageProc bufferStorage = nullptr;
+
+        bool hasExtension(const char* name) {
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (GLint i = 0; i < count; i++) {
+                const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+                if (extension && std::strcmp(extension, name) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    bool StreamBuffer::loadExtensions(GLADloadproc load) {
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+        bufferStorage = nullptr;
+        if (major > 4 || (major == 4 && minor >= 4) || hasExtension("GL_ARB_buffer_storage")) {
+            bufferStorage = (BufferStorageProc)load("glBufferStorage");
+        }
+        return bufferStorage != nullptr;
+    }
+
+    bool StreamBuffer::isPersistentMappingSupported() {
+        return bufferStorage != nullptr;
+    }
+
+    StreamBuffer::StreamBuffer(size_t regionSize, unsigned int regionCount)
+    : buffer(0), generation(0), regionSize(regionSize), pendingRegionSize(regionSize), fences(std::max(regionCount, 1u), nullptr),
+      region(0), head(0), regionEnd(0), frameBytes(0), frameDemand(0), persistentRequested(true), recreate(false),
+      persistentData(nullptr), mapped(false), memoryHandle(GpuMemory::INVALID_HANDLE) {}
+
+    StreamBuffer::~StreamBuffer() {
+        cleanup();
+    }
+
+    void StreamBuffer::setPersistentMapping(bool enabled) {
+        if (enabled != persistentRequested) {
+            persistentRequested = enabled;
+            recreate = true;
+        }
+    }
+
+    void StreamBuffer::create() {
+        size_t size = regionSize * fences.size();
+
+        glGenBuffers(1, &buffer);
+        generation++;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        if (persistentRequested && bufferStorage) {
+            // Coherent mapping: writes are visible to commands issued afterwards without a flush
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            bufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+            persistentData = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+            if (!persistentData) {
+                std::cerr << "ERROR::STREAM_BUFFER::PERSISTENT_MAP_FAILED" << std::endl;
+            }
+        }
+        if (!persistentData) {
+            glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        region = 0;
+        memoryHandle = GpuMemory::track(GpuMemory::Category::STREAMING, "StreamBuffer", size);
+    }
+
+    void StreamBuffer::destroy() {
+        for (GLsync& fence : fences) {
+            if (fence) {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+        if (buffer) {
+            // The driver keeps the storage alive until pending draws are done
+            if (persistentData) {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+                glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                persistentData = nullptr;
+            }
+            glDeleteBuffers(1, &buffer);
+            buffer = 0;
+        }
+        GpuMemory::release(memoryHandle);
+    }
+
+    void StreamBuffer::beginFrame() {
+        if (recreate || pendingRegionSize != regionSize) {
+            destroy();
+            regionSize = pendingRegionSize;
+            recreate = false;
+        }
+        if (buffer == 0) {
+            create();
+        } else {
+            region = (region + 1) % fences.size();
+        }
+
+        // Only blocks when the GPU is still reading the region from regionCount frames ago
+        stats.lastWaitMs = 0.0;
+        GLsync& fence = fences[region];
+        if (fence) {
+            GLenum status = glClientWaitSync(fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) {
+                auto start = std::chrono::steady_clock::now();
+                do {
+                    status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+                } while (status == GL_TIMEOUT_EXPIRED);
+                stats.lastWaitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                stats.totalWaitMs += stats.lastWaitMs;
+                stats.fenceWaits++;
+            }
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+
+        head = region * regionSize;
+        regionEnd = head + regionSize;
+        frameBytes = 0;
+        frameDemand = 0;
+    }
+
+    void* StreamBuffer::map(size_t size, size_t alignment, size_t& offset) {
+        size_t aligned = alignment > 1 ? (head + alignment - 1) / alignment * alignment : head;
+        frameDemand += size + alignment;
+        if (buffer == 0 || aligned + size > regionEnd) {
+            // The current frame goes without, the next one gets regions large enough for all of it
+            stats.overflows++;
+            pendingRegionSize = std::max(pendingRegionSize, regionSize * 2);
+            while (pendingRegionSize < frameDemand) {
+                pendingRegionSize *= 2;
+            }
+            offset = INVALID_OFFSET;
+            return nullptr;
+        }
+
+        static unsigned char empty;
+        void* data;
+        if (persistentData) {
+            data = persistentData + aligned;
+        } else if (size == 0) {
+            data = &empty;
+        } else {
+            // The fence already guarantees the GPU is done with this range
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            data = glMapBufferRange(GL_COPY_WRITE_BUFFER, aligned, size,
+                GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+            if (!data) {
+                // Nothing is reserved, the caller skips its upload as on an overflow
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                stats.mapFailures++;
+                offset = INVALID_OFFSET;
+                return nullptr;
+            }
+            mapped = true;
+        }
+
+        offset = aligned;
+        head = aligned + size;
+        frameBytes += size;
+        stats.allocations++;
+        return data;
+    }
+
+    void StreamBuffer::unmap() {
+        if (mapped) {
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            mapped = false;
+        }
+    }
+
+    size_t StreamBuffer::write(const void* data, size_t size, size_t alignment) {
+        size_t offset;
+        void* destination = map(size, alignment, offset);
+        if (destination) {
+            std::memcpy(destination, data, size);
+            unmap();
+        }
+        return offset;
+    }
+
+    void StreamBuffer::endFrame() {
+        if (buffer == 0) {
+            return;
+        }
+        if (fences[region]) {
+            glDeleteSync(fences[region]);
+        }
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        stats.bytesLastFrame = frameBytes;
+        stats.bytesStreamed += frameBytes;
+    }
+
+    void StreamBuffer::cleanup() {
+        unmap();
+        destroy();
+        head = regionEnd = 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include <glengine/textureCache.hpp>
+#include <glengine/trace.hpp>
+#include <glad/glad.h>
+#include <stbimage/stb_image.h>
+#include <stbimage/stb_image_resize2.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace GLEngine {
+    namespace {
+        // FNV-1a over the encoded file, identical files share one decode and one texture
+        uint64_t hashContent(const std::vector<unsigned char>& bytes) {
+            uint64_t hash = 14695981039346656037ull;
+            for (unsigned char byte : bytes) {
+                hash = (hash ^ byte) * 1099511628211ull;
+            }
+            return hash ^ bytes.size();
+        }
+    }
+
+    TextureCache::TextureCache(size_t gpuBudget, size_t uploadBudget, unsigned int threadCount)
+    : fallbackTexture(0), fallbackMemoryHandle(GpuMemory::INVALID_HANDLE), gpuBudget(gpuBudget), uploadBudget(uploadBudget), gpuMemory(0), uploadedLastFrame(0),
+      frameIndex(0), decodeCount(0), dedupCount(0), evictionCount(0), workers(threadCount) {}
+
+    TextureCache::~TextureCache() {
+        cleanup();
+    }
+
+    TextureCache::Handle TextureCache::load(const std::string& path) {
+        std::string key = std::filesystem::path(path).lexically_normal().string();
+        auto it = handlesByPath.find(key);
+        if (it != handlesByPath.end()) {
+            return it->second;
+        }
+
+        Handle handle = (Handle)entries.size();
+        Entry entry;
+        entry.path = key;
+        entry.state = State::QUEUED;
+        entry.alias = INVALID_HANDLE;
+        entry.texture = 0;
+        entry.memory = 0;
+        entry.memoryHandle = GpuMemory::INVALID_HANDLE;
+        entry.lastUsed = frameIndex;
+        entry.nextLevel = -1;
+        entries.push_back(std::move(entry));
+        handlesByPath.emplace(key, handle);
+
+        request(handle);
+        return handle;
+    }
+
+    void TextureCache::request(Handle handle) {
+        Entry& entry = entries[handle];
+        entry.state = State::QUEUED;
+        std::string path = entry.path;
+        workers.submit([this, handle, path]() {
+            decode(handle, path);
+        });
+    }
+
+    void TextureCache::decode(Handle handle, const std::string& path) {
+        GLENGINE_TRACE_ZONE("TextureCache::decode");
+        auto result = std::make_unique<Decoded>();
+        result->handle = handle;
+        result->alias = INVALID_HANDLE;
+
+        std::ifstream file(path, std::ios::binary);
+        std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        bool duplicate = false;
+        if (!bytes.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto inserted = ownersByHash.emplace(hashContent(bytes), handle);
+            if (!inserted.second && inserted.first->second != handle) {
+                result->alias = inserted.first->second;
+                duplicate = true;
+            }
+        }
+
+        int width = 0, height = 0, channels = 0;
+        unsigned char* data = nullptr;
+        if (!duplicate && !bytes.empty()) {
+            data = stbi_load_from_memory(bytes.data(), (int)bytes.size(), &width, &height, &channels, 4);
+        }
+
+        if (data) {
+            result->levels.push_back({ width, height, std::vector<unsigned char>(data, data + (size_t)width * height * 4) });
+            stbi_image_free(data);
+
+            // Full mip chain, each level filtered from the previous one in sRGB space
+            while (width > 1 || height > 1) {
+                const MipLevel& previous = result->levels.back();
+                MipLevel level;
+                level.width = std::max(width / 2, 1);
+                level.height = std::max(height / 2, 1);
+                level.pixels.resize((size_t)level.width * level.height * 4);
+                stbir_resize_uint8_srgb(previous.pixels.data(), width, height, 0,
+                    level.pixels.data(), level.width, level.height, 0, STBIR_RGBA);
+                width = level.width;
+                height = level.height;
+                result->levels.push_back(std::move(level));
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        completed.push_back(std::move(result));
+    }
+
+    TextureCache::Handle TextureCache::resolve(Handle handle) const {
+        // Owners are never aliases themselves, one hop is enough
+        return entries[handle].alias != INVALID_HANDLE ? entries[handle].alias : handle;
+    }
+
+    void TextureCache::bind(Handle handle, int textureUnit) {
+        if (fallbackTexture == 0) {
+            // Opaque white, so an unfinished texture only leaves objectColor
+            const unsigned char white[4] = { 255, 255, 255, 255 };
+            glGenTextures(1, &fallbackTexture);
+            glBindTexture(GL_TEXTURE_2D, fallbackTexture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            fallbackMemoryHandle = GpuMemory::track(GpuMemory::Category::TEXTURE, "Fallback texture", sizeof(white));
+        }
+
+        unsigned int texture = fallbackTexture;
+        if (handle < entries.size()) {
+            Entry& owner = entries[resolve(handle)];
+            owner.lastUsed = frameIndex;
+            entries[handle].lastUsed = frameIndex;
+            if (owner.state == State::EVICTED) {
+                request(resolve(handle));
+            }
+            if (owner.texture) {
+                texture = owner.texture;
+            }
+        }
+
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    bool TextureCache::isReady(Handle handle) const {
+        return handle < entries.size() && entries[resolve(handle)].state == State::RESIDENT;
+    }
+
+    void TextureCache::update() {
+        GLENGINE_TRACE_ZONE("TextureCache::update");
+        frameIndex++;
+        uploadedLastFrame = 0;
+
+        std::vector<std::unique_ptr<Decoded>> done;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.swap(completed);
+        }
+        for (auto& decoded : done) {
+            Entry& entry = entries[decoded->handle];
+            if (decoded->alias != INVALID_HANDLE) {
+                entry.alias = decoded->alias;
+                entry.state = State::RESIDENT;
+                dedupCount++;
+            } else if (decoded->levels.empty()) {
+                entry.state = State::FAILED;
+                std::cerr << "ERROR::TEXTURE_CACHE::DECODE_FAILED: " << entry.path << std::endl;
+            } else {
+                decodeCount++;
+                entry.nextLevel = (int)decoded->levels.size() - 1;
+                entry.decoded = std::move(decoded);
+                entry.state = State::UPLOADING;
+                uploadQueue.push_back(entry.decoded->handle);
+            }
+        }
+
+        // At least one mip level goes up per frame, however large
+        while (!uploadQueue.empty() && uploadedLastFrame < uploadBudget) {
+            Entry& entry = entries[uploadQueue.front()];
+            uploadLevel(entry);
+            if (entry.nextLevel < 0) {
+                entry.decoded.reset();
+                entry.state = State::RESIDENT;
+                uploadQueue.pop_front();
+            }
+        }
+
+        evict();
+    }
+
+    void TextureCache::uploadLevel(Entry& entry) {
+        int level = entry.nextLevel;
+        MipLevel& mip = entry.decoded->levels[level];
+
+        if (entry.texture == 0) {
+            glGenTextures(1, &entry.texture);
+            glBindTexture(GL_TEXTURE_2D, entry.texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level);
+        } else {
+            glBindTexture(GL_TEXTURE_2D, entry.texture);
+        }
+
+        // Coarsest levels first: the base level walks down as finer ones arrive
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, mip.pixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        size_t bytes = mip.pixels.size();
+        entry.memory += bytes;
+        gpuMemory += bytes;
+        if (entry.memoryHandle == GpuMemory::INVALID_HANDLE) {
+            entry.memoryHandle = GpuMemory::track(GpuMemory::Category::TEXTURE,
+                std::filesystem::path(entry.path).filename().string(), entry.memory);
+        } else {
+            GpuMemory::resize(entry.memoryHandle, entry.memory);
+        }
+        uploadedLastFrame += bytes;
+        std::vector<unsigned char>().swap(mip.pixels);
+        entry.nextLevel--;
+    }
+
+    void TextureCache::evict() {
+        while (gpuMemory > gpuBudget) {
+            // Least recently used texture that was not bound last frame
+            Entry* victim = nullptr;
+            for (auto& entry : entries) {
+                if (entry.state == State::RESIDENT && entry.texture && entry.lastUsed + 1 < frameIndex &&
+                    (!victim || entry.lastUsed < victim->lastUsed)) {
+                    victim = &entry;
+                }
+            }
+            if (!victim) {
+                break;
+            }
+
+            glDeleteTextures(1, &victim->texture);
+            victim->texture = 0;
+            gpuMemory -= victim->memory;
+            victim->memory = 0;
+            GpuMemory::release(victim->memoryHandle);
+            victim->state = State::EVICTED;
+            evictionCount++;
+        }
+    }
+
+    size_t TextureCache::getResidentCount() const {
+        return std::count_if(entries.begin(), entries.end(), [](const Entry& entry) {
+            return entry.state == State::RESIDENT && entry.texture != 0;
+        });
+    }
+
+    size_t TextureCache::getPendingCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return workers.getPendingCount() + completed.size() + uploadQueue.size();
+    }
+
+    void TextureCache::cleanup() {
+        workers.wait();
+        for (auto& entry : entries) {
+            if (entry.texture) {
+                glDeleteTextures(1, &entry.texture);
+            }
+            GpuMemory::release(entry.memoryHandle);
+        }
+        if (fallbackTexture) {
+            glDeleteTextures(1, &fallbackTexture);
+            fallbackTexture = 0;
+        }
+        GpuMemory::release(fallbackMemoryHandle);
+        entries.clear();
+        handlesByPath.clear();
+        uploadQueue.clear();
+        gpuMemory = 0;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ownersByHash.clear();
+        completed.clear();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include <glengine/threadPool.hpp>
+#include <glengine/allocStats.hpp>
+#include <glengine/trace.hpp>
+#include <algorithm>
+
+namespace GLEngine {
+    ThreadPool::ThreadPool(unsigned int threadCount) : running(0), stopping(false) {
+        if (threadCount == 0) {
+            // Leave one core to the render thread
+            threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        }
+        threads.reserve(threadCount);
+        for (unsigned int i = 0; i < threadCount; i++) {
+            threads.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        shutdown();
+    }
+
+    void ThreadPool::submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        taskAvailable.notify_one();
+    }
+
+    void ThreadPool::wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return tasks.empty() && running == 0; });
+    }
+
+    bool ThreadPool::waitForPendingBelow(size_t count, std::chrono::microseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return idle.wait_for(lock, timeout, [this, count] { return tasks.size() + running < count; });
+    }
+
+    size_t ThreadPool::getPendingCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return tasks.size() + running;
+    }
+
+    void ThreadPool::shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                return;
+            }
+            stopping = true;
+        }
+        taskAvailable.notify_all();
+        // Queued tasks are still run before the workers exit
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+    }
+
+    void ThreadPool::workerLoop() {
+        GLENGINE_TRACE_THREAD("Pool Worker");
+        AllocStats::setThreadName("Pool Worker");
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                running++;
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running--;
+            }
+            // Wakes both wait() and bounded producers waiting for room
+            idle.notify_all();
+        }
+    }
+}
\ No newline at end of file
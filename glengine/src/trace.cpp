@@ -0,0 +1,151 @@
+#include <glengine/trace.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace GLEngine {
+    namespace {
+        // Buffers outlive their threads so worker zones can still be exported at exit
+        std::mutex registryMutex;
+        std::vector<std::unique_ptr<Trace::ThreadBuffer>>& registry() {
+            static std::vector<std::unique_ptr<Trace::ThreadBuffer>> buffers;
+            return buffers;
+        }
+
+        // Tick to nanosecond conversion, measured between the first registration and the export
+        struct Calibration {
+            uint64_t ticks;
+            uint64_t nanoseconds;
+        };
+        Calibration calibrationStart = { 0, 0 };
+
+        void writeEscaped(std::ostream& out, const char* text) {
+            for (; *text; text++) {
+                if (*text == '"' || *text == '\\') {
+                    out << '\\';
+                }
+                out << *text;
+            }
+        }
+    }
+
+    thread_local Trace::ThreadBuffer* Trace::threadBuffer = nullptr;
+    thread_local const char* Trace::currentZone = nullptr;
+
+    Trace::ThreadBuffer* Trace::registerThread() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        if (registry().empty()) {
+            calibrationStart = { now(), steadyNanoseconds() };
+        }
+        registry().push_back(std::make_unique<ThreadBuffer>());
+        threadBuffer = registry().back().get();
+        threadBuffer->id = (uint32_t)registry().size();
+        threadBuffer->name = "Thread " + std::to_string(threadBuffer->id);
+        return threadBuffer;
+    }
+
+    void Trace::setThreadName(const std::string& name) {
+        ThreadBuffer* buffer = threadBuffer ? threadBuffer : registerThread();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->name = name;
+    }
+
+    uint64_t Trace::getEventCount() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        uint64_t count = 0;
+        for (const auto& buffer : registry()) {
+            count += std::min<uint64_t>(buffer->head.load(std::memory_order_acquire), RING_SIZE);
+        }
+        return count;
+    }
+
+    bool Trace::write(const std::string& path) {
+        std::error_code error;
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty()) {
+            std::filesystem::create_directories(parent, error);
+        }
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            std::cerr << "ERROR::TRACE::OPEN_FAILED: " << path << std::endl;
+            return false;
+        }
+
+        struct Copy {
+            uint32_t id;
+            std::string name;
+            std::vector<Event> events;
+        };
+        std::vector<Copy> copies;
+        uint64_t origin = ~uint64_t(0);
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            Calibration calibrationEnd = { now(), steadyNanoseconds() };
+            double nanosecondsPerTick = 1.0;
+#ifdef GLENGINE_TRACE_TSC
+            if (calibrationEnd.ticks > calibrationStart.ticks) {
+                nanosecondsPerTick = (double)(calibrationEnd.nanoseconds - calibrationStart.nanoseconds) /
+                    (double)(calibrationEnd.ticks - calibrationStart.ticks);
+            }
+#endif
+            auto toNanoseconds = [&](uint64_t ticks) {
+                return calibrationStart.nanoseconds +
+                    (uint64_t)((double)(int64_t)(ticks - calibrationStart.ticks) * nanosecondsPerTick);
+            };
+
+            for (const auto& buffer : registry()) {
+                Copy copy = { buffer->id, buffer->name, {} };
+                uint64_t head = buffer->head.load(std::memory_order_acquire);
+                uint64_t first = head > RING_SIZE ? head - RING_SIZE : 0;
+                for (uint64_t i = first; i < head; i++) {
+                    copy.events.push_back(buffer->events[i & (RING_SIZE - 1)]);
+                }
+
+                // The owner may have wrapped over the oldest slots while they were copied
+                uint64_t after = buffer->head.load(std::memory_order_acquire);
+                uint64_t valid = after > RING_SIZE ? after - RING_SIZE : 0;
+                if (valid > first) {
+                    copy.events.erase(copy.events.begin(),
+                        copy.events.begin() + (ptrdiff_t)std::min<uint64_t>(valid - first, copy.events.size()));
+                }
+                for (Event& event : copy.events) {
+                    if (event.start & NANOSECONDS_FLAG) {
+                        event.start &= ~NANOSECONDS_FLAG;
+                    } else {
+                        event.start = toNanoseconds(event.start);
+                        event.end = toNanoseconds(event.end);
+                    }
+                    event.end = std::max(event.end, event.start);
+                    origin = std::min(origin, event.start);
+                }
+                copies.push_back(std::move(copy));
+            }
+        }
+
+        // Complete events ("X") in microseconds from the first recorded zone
+        file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+        bool first = true;
+        for (const Copy& copy : copies) {
+            file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << copy.id
+                 << ",\"args\":{\"name\":\"";
+            writeEscaped(file, copy.name.c_str());
+            file << "\"}}";
+            first = false;
+
+            for (const Event& event : copy.events) {
+                file << ",\n{\"name\":\"";
+                writeEscaped(file, event.name ? event.name : "?");
+                file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << copy.id
+                     << ",\"ts\":" << (double)(event.start - origin) / 1000.0
+                     << ",\"dur\":" << (double)(event.end - event.start) / 1000.0 << "}";
+            }
+        }
+        file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        return (bool)file;
+    }
+}
\ No newline at end of file
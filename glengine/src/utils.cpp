@@ -1,8 +1,15 @@
 #include <glengine/utils.hpp>
+#include <glengine/trace.hpp>
 #include <GLFW/glfw3.h>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <memory_resource>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
 
 namespace GLEngine {
     std::string readFile(const char* filePath) {
@@ -16,15 +23,81 @@ namespace GLEngine {
         return buffer.str();
     }
 
+    namespace {
+        // Rest of the line after the keyword, without surrounding blanks or a CR
+        std::string readName(std::istringstream& iss) {
+            std::string name;
+            std::getline(iss >> std::ws, name);
+            while (!name.empty() && (name.back() == '\r' || name.back() == ' ' || name.back() == '\t')) {
+                name.pop_back();
+            }
+            return name;
+        }
+
+        unsigned int findOrAddMaterial(std::vector<Material>& materials, const std::string& name) {
+            for (size_t i = 0; i < materials.size(); i++) {
+                if (materials[i].name == name) {
+                    return (unsigned int)i;
+                }
+            }
+            Material material;
+            material.name = name;
+            materials.push_back(material);
+            return (unsigned int)materials.size() - 1;
+        }
+
+        // v/vt/vn triplet of a face corner, 0 for a missing texcoord or normal
+        struct VertexKey {
+            uint32_t position, texCoord, normal;
+
+            bool operator==(const VertexKey& other) const {
+                return position == other.position && texCoord == other.texCoord && normal == other.normal;
+            }
+        };
+
+        struct VertexKeyHash {
+            size_t operator()(const VertexKey& key) const {
+                uint64_t hash = key.position * 0x9E3779B97F4A7C15ull;
+                hash = (hash ^ key.texCoord) * 0xBF58476D1CE4E5B9ull;
+                hash = (hash ^ key.normal) * 0x94D049BB133111EBull;
+                return (size_t)(hash ^ (hash >> 31));
+            }
+        };
+    }
+
     void loadObjFile(const char* filePath, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, bool& hasTexCoords) {
-        std::vector<glm::vec3> temp_positions;
-        std::vector<glm::vec2> temp_texcoords;
-        std::vector<glm::vec3> temp_normals;
-        std::vector<int> vertex_map;
+        std::vector<SubMesh> subMeshes;
+        std::vector<Material> materials;
+        loadObjFile(filePath, vertices, indices, subMeshes, materials, hasTexCoords);
+    }
+
+    void loadObjFile(const char* filePath, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+                     std::vector<SubMesh>& subMeshes, std::vector<Material>& materials, bool& hasTexCoords) {
+        GLENGINE_TRACE_ZONE("loadObjFile");
+        // Parsing data lives in one arena, handed back in a few large blocks when the load returns
+        std::pmr::monotonic_buffer_resource scratch(1u << 20);
+        std::pmr::vector<glm::vec3> temp_positions(&scratch);
+        std::pmr::vector<glm::vec2> temp_texcoords(&scratch);
+        std::pmr::vector<glm::vec3> temp_normals(&scratch);
+        std::pmr::unordered_map<VertexKey, unsigned int, VertexKeyHash> vertex_map(&scratch);
         hasTexCoords = false;
+        subMeshes.clear();
+        materials.clear();
+
+        // Faces are gathered per (group, material) run, then laid out grouped by material
+        struct Run {
+            std::string name;
+            unsigned int material;
+            std::pmr::vector<unsigned int> indices;
+        };
+        std::pmr::vector<Run> runs(&scratch);
+        std::string groupName;
+        int currentMaterial = -1;
+        std::filesystem::path directory = std::filesystem::path(filePath).parent_path();
 
         std::ifstream file(filePath);
         std::string line;
+        std::pmr::vector<unsigned int> corners(&scratch);
         
         while (std::getline(file, line)) {
             std::istringstream iss(line);
@@ -47,53 +120,155 @@ namespace GLEngine {
                 iss >> normal.x >> normal.y >> normal.z;
                 temp_normals.push_back(normal);
             }
+            else if (type == "mtllib") {
+                loadMtlFile((directory / readName(iss)).string().c_str(), materials);
+            }
+            else if (type == "usemtl") {
+                currentMaterial = (int)findOrAddMaterial(materials, readName(iss));
+            }
+            else if (type == "o" || type == "g") {
+                groupName = readName(iss);
+            }
             else if (type == "f") {
                 std::string vertex;
-                std::vector<std::string> face_vertices;
+                corners.clear();
                 while (iss >> vertex) {
-                    face_vertices.push_back(vertex);
-                }
-
-                for (int i = 0; i < 3; i++) {
-                    std::istringstream vertex_stream(face_vertices[i]);
-                    std::string index_str;
-                    std::vector<int> face_indices;
+                    int face_indices[3] = { 0, 0, 0 };
+                    const int counts[3] = { (int)temp_positions.size(), (int)temp_texcoords.size(), (int)temp_normals.size() };
 
-                    while (std::getline(vertex_stream, index_str, '/')) {
-                        if (index_str.empty()) {
-                            face_indices.push_back(0);
-                        } else {
-                            face_indices.push_back(std::stoi(index_str));
+                    // v, v/vt, v//vn or v/vt/vn, parsed in place
+                    const char* cursor = vertex.c_str();
+                    for (int k = 0; k < 3; k++) {
+                        if (*cursor != '/' && *cursor != '\0') {
+                            char* end = nullptr;
+                            int index = (int)std::strtol(cursor, &end, 10);
+                            // Negative indices count back from the latest element
+                            face_indices[k] = index < 0 ? counts[k] + index + 1 : index;
+                            cursor = end;
                         }
+                        if (*cursor != '/') {
+                            break;
+                        }
+                        cursor++;
+                    }
+
+                    // Corners sharing the same v/vt/vn triplet become a single vertex
+                    VertexKey key = { (uint32_t)face_indices[0], (uint32_t)face_indices[1], (uint32_t)face_indices[2] };
+
+                    auto found = vertex_map.find(key);
+                    if (found != vertex_map.end()) {
+                        corners.push_back(found->second);
+                        continue;
                     }
 
                     Vertex vert;
                     vert.position = temp_positions[face_indices[0] - 1];
                     
-                    if (face_indices.size() > 1 && face_indices[1] != 0) {
+                    if (face_indices[1] != 0) {
                         vert.texCoords = temp_texcoords[face_indices[1] - 1];
                     } else {
                         vert.texCoords = glm::vec2(0.0f);
                     }
                     
-                    if (face_indices.size() > 2 && face_indices[2] != 0) {
+                    if (face_indices[2] != 0) {
                         vert.normal = temp_normals[face_indices[2] - 1];
                     } else {
                         vert.normal = glm::vec3(0.0f);
                     }
 
+                    vertex_map.emplace(key, (unsigned int)vertices.size());
+                    corners.push_back(vertices.size());
                     vertices.push_back(vert);
-                    indices.push_back(indices.size());
+                }
+
+                if (corners.size() < 3) {
+                    continue;
+                }
+
+                // Faces without usemtl share a default material
+                unsigned int material = currentMaterial >= 0 ? (unsigned int)currentMaterial : findOrAddMaterial(materials, "default");
+                if (runs.empty() || runs.back().material != material || runs.back().name != groupName) {
+                    runs.push_back({ groupName, material, std::pmr::vector<unsigned int>(&scratch) });
+                }
+
+                // Polygons are triangulated as a fan
+                std::pmr::vector<unsigned int>& runIndices = runs.back().indices;
+                for (size_t i = 1; i + 1 < corners.size(); i++) {
+                    runIndices.push_back(corners[0]);
+                    runIndices.push_back(corners[i]);
+                    runIndices.push_back(corners[i + 1]);
                 }
             }
         }
 
+        // One contiguous index range per material, so sorted draws can merge
+        std::stable_sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) {
+            return a.material < b.material;
+        });
+        for (const auto& run : runs) {
+            if (!subMeshes.empty() && subMeshes.back().material == run.material && subMeshes.back().name == run.name) {
+                subMeshes.back().indexCount += run.indices.size();
+            } else {
+                subMeshes.push_back({ run.name, (unsigned int)indices.size(), (unsigned int)run.indices.size(), run.material });
+            }
+            indices.insert(indices.end(), run.indices.begin(), run.indices.end());
+        }
+
         if (temp_normals.empty()) {
             computeNormals(vertices, indices);
         }
     }
 
+    void loadMtlFile(const char* filePath, std::vector<Material>& materials) {
+        GLENGINE_TRACE_ZONE("loadMtlFile");
+        std::ifstream file(filePath);
+        if (!file) {
+            std::cout << "ERROR::MTL::FILE_NOT_FOUND: " << filePath << std::endl;
+            return;
+        }
+
+        std::filesystem::path directory = std::filesystem::path(filePath).parent_path();
+        int current = -1;
+        std::string line;
+
+        while (std::getline(file, line)) {
+            std::istringstream iss(line);
+            std::string type;
+            iss >> type;
+
+            if (type == "newmtl") {
+                current = (int)findOrAddMaterial(materials, readName(iss));
+            }
+            else if (current < 0) {
+                continue;
+            }
+            else if (type == "Kd") {
+                glm::vec3& diffuse = materials[current].diffuse;
+                iss >> diffuse.r >> diffuse.g >> diffuse.b;
+            }
+            else if (type == "Ks") {
+                glm::vec3 specular(0.0f);
+                iss >> specular.r >> specular.g >> specular.b;
+                materials[current].specular = std::max(specular.r, std::max(specular.g, specular.b));
+            }
+            else if (type == "Ns") {
+                iss >> materials[current].shininess;
+            }
+            else if (type == "map_Kd") {
+                // Options (-s, -o, ...) come first, the file name is the last token
+                std::string token, name;
+                while (iss >> token) {
+                    name = token;
+                }
+                if (!name.empty()) {
+                    materials[current].diffuseMapPath = (directory / name).lexically_normal().string();
+                }
+            }
+        }
+    }
+
     void computeNormals(std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+        GLENGINE_TRACE_ZONE("computeNormals");
         for (auto& vertex : vertices) {
             vertex.normal = glm::vec3(0.0f);
         }
@@ -0,0 +1,431 @@
+#include <glengine/videoStream.hpp>
+#include <algorithm>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GLENGINE_YUV_SSE2
+#endif
+
+namespace GLEngine {
+    namespace {
+        // The writer looks for a cancellation at least this often while the output is not ready
+        constexpr int POLL_INTERVAL_MS = 50;
+        // stop() gives pending frames this long to go out before the writer is cancelled
+        constexpr auto STOP_TIMEOUT = std::chrono::seconds(1);
+
+        // BT.601 full range (y4m C420jpeg) in 8-bit fixed point
+        inline unsigned char luma(int r, int g, int b) {
+            return (unsigned char)((77 * r + 150 * g + 29 * b + 128) >> 8);
+        }
+
+        // Chroma takes the channel sums of a 2x2 block, hence the extra shift by 2
+        inline unsigned char chroma(int sum) {
+            return (unsigned char)std::clamp(((sum + 512) >> 10) + 128, 0, 255);
+        }
+
+#ifdef GLENGINE_YUV_SSE2
+        // Weighted sum of 4 RGBA pixels: one int32 per pixel
+        inline __m128i weigh4(__m128i lo, __m128i hi, __m128i coefficients) {
+            __m128i a = _mm_madd_epi16(lo, coefficients);
+            __m128i b = _mm_madd_epi16(hi, coefficients);
+            __m128 even = _mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 odd = _mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1));
+            return _mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd));
+        }
+
+        inline __m128i luma4(const unsigned char* rgba, __m128i coefficients) {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i pixels = _mm_loadu_si128((const __m128i*)rgba);
+            __m128i sum = weigh4(_mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero), coefficients);
+            return _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(128)), 8);
+        }
+
+        // Channel sums of the two 2x2 blocks covered by 4 pixels of two rows
+        inline __m128i blockSums2(const unsigned char* row0, const unsigned char* row1) {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i a = _mm_loadu_si128((const __m128i*)row0);
+            __m128i b = _mm_loadu_si128((const __m128i*)row1);
+            __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+            hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+            return _mm_unpacklo_epi64(lo, hi);
+        }
+#endif
+    }
+
+    VideoStream::VideoStream(int fps, int maxQueuedFrames)
+    : fps(fps), maxQueuedFrames(maxQueuedFrames), streaming(false), width(0), height(0), slots{}, next(0),
+      memoryHandle(GpuMemory::INVALID_HANDLE), output(-1), outputFlags(0), error(false), cancelled(false), framesWritten(0),
+      framesDropped(0), bytesWritten(0), convertTimeMs(0.0f), writer(1) {}
+
+    VideoStream::~VideoStream() {
+        cleanup();
+    }
+
+    bool VideoStream::start(const std::string& _path, int _width, int _height) {
+        stop();
+
+        // 4:2:0 needs even dimensions
+        width = _width & ~1;
+        height = _height & ~1;
+        if (width < 2 || height < 2) {
+            return false;
+        }
+
+#ifdef SIGPIPE
+        // A closed pipe must surface as a write error, not kill the application
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+        for (auto& slot : slots) {
+            if (slot.pbo == 0) {
+                glGenBuffers(1, &slot.pbo);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)width * height * 4, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        size_t ringBytes = slots.size() * (size_t)width * height * 4;
+        if (memoryHandle == GpuMemory::INVALID_HANDLE) {
+            memoryHandle = GpuMemory::track(GpuMemory::Category::READBACK, "VideoStream", ringBytes);
+        } else {
+            GpuMemory::resize(memoryHandle, ringBytes);
+        }
+
+        path = _path;
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if (path != "-" && !parent.empty()) {
+            std::error_code ignored;
+            std::filesystem::create_directories(parent, ignored);
+        }
+        error = false;
+        framesWritten = 0;
+        framesDropped = 0;
+        bytesWritten = 0;
+        convertTimeMs = 0.0f;
+        startTime = std::chrono::steady_clock::now();
+        streaming = true;
+        return true;
+    }
+
+    void VideoStream::capture(int _width, int _height, unsigned int framebuffer) {
+        if (!streaming) {
+            return;
+        }
+
+        // Waiting on the GPU or the writer never costs more than one frame
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(1000000 / std::max(fps, 1));
+        Slot& slot = slots[next];
+        if (slot.fence && !handOff(slot, deadline)) {
+            framesDropped++;
+            return;
+        }
+        if (_width < width || _height < height) {
+            framesDropped++;
+            return;
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        next ^= 1;
+    }
+
+    bool VideoStream::handOff(Slot& slot, std::chrono::steady_clock::time_point deadline) {
+        auto remaining = std::max(deadline - std::chrono::steady_clock::now(), std::chrono::steady_clock::duration::zero());
+        GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+            (GLuint64)std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count());
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            return false;
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        if (error) {
+            return true;
+        }
+        // The downstream encoder is behind: this frame is lost but the slot is free again
+        remaining = std::max(deadline - std::chrono::steady_clock::now(), std::chrono::steady_clock::duration::zero());
+        if (!writer.waitForPendingBelow(maxQueuedFrames, std::chrono::duration_cast<std::chrono::microseconds>(remaining))) {
+            framesDropped++;
+            return true;
+        }
+
+        std::vector<unsigned char> pixels;
+        {
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            if (!freeBuffers.empty()) {
+                pixels = std::move(freeBuffers.back());
+                freeBuffers.pop_back();
+            }
+        }
+        size_t size = (size_t)width * height * 4;
+        pixels.resize(size);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+        if (data) {
+            std::memcpy(pixels.data(), data, size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (!data) {
+            framesDropped++;
+            return true;
+        }
+
+        writer.submit([this, pixels = std::move(pixels)]() mutable {
+            write(std::move(pixels));
+        });
+        return true;
+    }
+
+    void VideoStream::write(std::vector<unsigned char> pixels) {
+        if (!error && !cancelled && output < 0) {
+            // Opened here because a named pipe has no reader until the consumer starts
+            char header[64];
+            int length = std::snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+            if (!openOutput() || !writeOutput(header, length)) {
+                if (!cancelled) {
+                    std::cerr << "ERROR::VIDEO_STREAM::OPEN_FAILED: " << path << std::endl;
+                }
+                error = true;
+            }
+        }
+
+        if (!error && !cancelled) {
+            auto convertStart = std::chrono::steady_clock::now();
+            size_t lumaSize = (size_t)width * height;
+            size_t chromaSize = lumaSize / 4;
+            yuv.resize(lumaSize + 2 * chromaSize);
+            convertToYUV420(pixels.data(), width, height, yuv.data(), yuv.data() + lumaSize,
+                yuv.data() + lumaSize + chromaSize);
+            float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - convertStart).count();
+            float previous = convertTimeMs.load();
+            convertTimeMs = previous == 0.0f ? ms : previous + 0.1f * (ms - previous);
+
+            if (!writeOutput("FRAME\n", 6) || !writeOutput(yuv.data(), yuv.size())) {
+                if (!cancelled) {
+                    std::cerr << "ERROR::VIDEO_STREAM::WRITE_FAILED: " << path << std::endl;
+                }
+                error = true;
+            } else {
+                framesWritten++;
+                bytesWritten += 6 + yuv.size();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        freeBuffers.push_back(std::move(pixels));
+    }
+
+    bool VideoStream::openOutput() {
+#ifdef _WIN32
+        // No non-blocking pipes here: a cancellation only skips the frames still queued
+        if (path == "-") {
+            output = _fileno(stdout);
+            _setmode(output, _O_BINARY);
+        } else {
+            output = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+        }
+        return output >= 0;
+#else
+        if (path == "-") {
+            output = STDOUT_FILENO;
+            outputFlags = fcntl(output, F_GETFL);
+            if (outputFlags != -1) {
+                fcntl(output, F_SETFL, outputFlags | O_NONBLOCK);
+            }
+            return true;
+        }
+        // A named pipe refuses a non-blocking writer until a reader opened it
+        for (;;) {
+            output = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NONBLOCK, 0644);
+            if (output >= 0 || errno != ENXIO || cancelled) {
+                return output >= 0;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+        }
+#endif
+    }
+
+    bool VideoStream::writeOutput(const void* data, size_t size) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        while (size > 0) {
+#ifdef _WIN32
+            int written = _write(output, bytes, (unsigned int)std::min(size, (size_t)INT_MAX));
+            if (written <= 0) {
+                return false;
+            }
+#else
+            ssize_t written = ::write(output, bytes, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if ((errno != EAGAIN && errno != EWOULDBLOCK) || cancelled) {
+                    return false;
+                }
+                // Pipe full: wait for the reader in short steps so stop() can cut in
+                pollfd descriptor = { output, POLLOUT, 0 };
+                poll(&descriptor, 1, POLL_INTERVAL_MS);
+                continue;
+            }
+#endif
+            bytes += written;
+            size -= (size_t)written;
+        }
+        return true;
+    }
+
+    void VideoStream::closeOutput() {
+        if (output < 0) {
+            return;
+        }
+#ifdef _WIN32
+        if (path != "-") {
+            _close(output);
+        }
+#else
+        if (path != "-") {
+            close(output);
+        } else if (outputFlags != -1) {
+            fcntl(output, F_SETFL, outputFlags);
+        }
+#endif
+        output = -1;
+    }
+
+    void VideoStream::stop() {
+        if (!streaming) {
+            return;
+        }
+        // Pending readbacks still go out, oldest first, all within one deadline
+        auto deadline = std::chrono::steady_clock::now() + STOP_TIMEOUT;
+        for (int i = 0; i < 2; i++) {
+            Slot& slot = slots[(next + i) % 2];
+            if (slot.fence && !handOff(slot, deadline)) {
+                glDeleteSync(slot.fence);
+                slot.fence = nullptr;
+            }
+        }
+        // A reader that is gone or never came must not hold the render thread: the writer gives up
+        auto remaining = std::max(deadline - std::chrono::steady_clock::now(), std::chrono::steady_clock::duration::zero());
+        if (!writer.waitForPendingBelow(1, std::chrono::duration_cast<std::chrono::microseconds>(remaining))) {
+            cancelled = true;
+        }
+        writer.wait();
+        cancelled = false;
+
+        closeOutput();
+        stopTime = std::chrono::steady_clock::now();
+        streaming = false;
+    }
+
+    double VideoStream::getElapsedTime() const {
+        auto end = streaming ? std::chrono::steady_clock::now() : stopTime;
+        return std::chrono::duration<double>(end - startTime).count();
+    }
+
+    double VideoStream::getThroughput() const {
+        double seconds = getElapsedTime();
+        return seconds > 0.0 ? (double)bytesWritten.load() / seconds / 1e6 : 0.0;
+    }
+
+    void VideoStream::cleanup() {
+        stop();
+        for (auto& slot : slots) {
+            if (slot.pbo) {
+                glDeleteBuffers(1, &slot.pbo);
+            }
+            slot = Slot{};
+        }
+        GpuMemory::release(memoryHandle);
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        freeBuffers.clear();
+    }
+
+    void VideoStream::convertToYUV420(const unsigned char* rgba, int width, int height,
+                                      unsigned char* y, unsigned char* u, unsigned char* v) {
+        const size_t stride = (size_t)width * 4;
+        const int chromaWidth = width / 2;
+
+#ifdef GLENGINE_YUV_SSE2
+        const __m128i coefY = _mm_setr_epi16(77, 150, 29, 0, 77, 150, 29, 0);
+        const __m128i coefU = _mm_setr_epi16(-43, -85, 128, 0, -43, -85, 128, 0);
+        const __m128i coefV = _mm_setr_epi16(128, -107, -21, 0, 128, -107, -21, 0);
+        const __m128i chromaRound = _mm_set1_epi32(512);
+        const __m128i chromaOffset = _mm_set1_epi16(128);
+#endif
+
+        for (int row = 0; row < height; row++) {
+            // Flip: the first output row is the last OpenGL row
+            const unsigned char* src = rgba + (size_t)(height - 1 - row) * stride;
+            unsigned char* dst = y + (size_t)row * width;
+            int x = 0;
+#ifdef GLENGINE_YUV_SSE2
+            for (; x + 16 <= width; x += 16) {
+                const unsigned char* p = src + x * 4;
+                __m128i lo = _mm_packs_epi32(luma4(p, coefY), luma4(p + 16, coefY));
+                __m128i hi = _mm_packs_epi32(luma4(p + 32, coefY), luma4(p + 48, coefY));
+                _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(lo, hi));
+            }
+#endif
+            for (; x < width; x++) {
+                const unsigned char* p = src + x * 4;
+                dst[x] = luma(p[0], p[1], p[2]);
+            }
+        }
+
+        for (int row = 0; row < height / 2; row++) {
+            const unsigned char* top = rgba + (size_t)(height - 1 - 2 * row) * stride;
+            const unsigned char* bottom = top - stride;
+            unsigned char* uDst = u + (size_t)row * chromaWidth;
+            unsigned char* vDst = v + (size_t)row * chromaWidth;
+            int x = 0;
+#ifdef GLENGINE_YUV_SSE2
+            for (; x + 4 <= chromaWidth; x += 4) {
+                __m128i blocks01 = blockSums2(top + x * 8, bottom + x * 8);
+                __m128i blocks23 = blockSums2(top + x * 8 + 16, bottom + x * 8 + 16);
+                __m128i u4 = _mm_srai_epi32(_mm_add_epi32(weigh4(blocks01, blocks23, coefU), chromaRound), 10);
+                __m128i v4 = _mm_srai_epi32(_mm_add_epi32(weigh4(blocks01, blocks23, coefV), chromaRound), 10);
+                __m128i packed = _mm_packus_epi16(_mm_add_epi16(_mm_packs_epi32(u4, v4), chromaOffset), _mm_setzero_si128());
+                int uBytes = _mm_cvtsi128_si32(packed);
+                int vBytes = _mm_cvtsi128_si32(_mm_srli_si128(packed, 4));
+                std::memcpy(uDst + x, &uBytes, 4);
+                std::memcpy(vDst + x, &vBytes, 4);
+            }
+#endif
+            for (; x < chromaWidth; x++) {
+                const unsigned char* p0 = top + x * 8;
+                const unsigned char* p1 = bottom + x * 8;
+                int r = p0[0] + p0[4] + p1[0] + p1[4];
+                int g = p0[1] + p0[5] + p1[1] + p1[5];
+                int b = p0[2] + p0[6] + p1[2] + p1[6];
+                uDst[x] = chroma(-43 * r - 85 * g + 128 * b);
+                vDst[x] = chroma(128 * r - 107 * g - 21 * b);
+            }
+        }
+    }
+}
\ No newline at end of file
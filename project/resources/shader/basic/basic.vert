@@ -3,10 +3,18 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// Per-view camera, see GLEngine::MultiView
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+invariant gl_Position;
 
 void main() 
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    vec3 worldPos = vec3(model * vec4(aPos, 1.0));
+    gl_Position = projection * view * vec4(worldPos, 1.0);
 }
\ No newline at end of file
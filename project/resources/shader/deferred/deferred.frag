@@ -0,0 +1,105 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedo;
+uniform sampler2D gDepth;
+uniform sampler2D gMaterial;
+// Part of the G-buffer covered by the current view: offset, size
+uniform vec4 texCoordRect;
+
+uniform mat4 invViewProjection;
+uniform vec3 viewPos;
+uniform vec3 lightPos;
+uniform vec3 lightColor;
+uniform float lightRadius;
+uniform float ambientStrength;
+uniform int specularModel;
+
+// Cached omnidirectional shadow of the scene light, see GLEngine::ShadowCubeMap
+uniform samplerCubeShadow shadowMap;
+uniform bool shadowsEnabled;
+uniform vec2 shadowDepthRange;
+
+vec3 decodeNormal(vec2 f)
+{
+    f = f * 2.0 - 1.0;
+    vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+float shadowFactor(vec3 fragPos, vec3 norm)
+{
+    if (!shadowsEnabled) {
+        return 1.0;
+    }
+
+    // The reference is the cube face depth of the light-to-fragment vector
+    vec3 fromLight = fragPos + norm * 0.01 - lightPos;
+    float localZ = max(abs(fromLight.x), max(abs(fromLight.y), abs(fromLight.z)));
+    float n = shadowDepthRange.x;
+    float f = shadowDepthRange.y;
+    float depth = (f + n) / (f - n) - (2.0 * f * n) / ((f - n) * localZ);
+    return texture(shadowMap, vec4(fromLight, depth * 0.5 + 0.5));
+}
+
+void main()
+{
+    vec2 uv = texCoordRect.xy + TexCoords * texCoordRect.zw;
+    float depth = texture(gDepth, uv).r;
+    if (depth == 1.0) {
+        discard;
+    }
+
+    // World position reconstructed from the depth buffer
+    vec4 clipPos = vec4(vec3(TexCoords, depth) * 2.0 - 1.0, 1.0);
+    vec4 worldPos = invViewProjection * clipPos;
+    vec3 fragPos = worldPos.xyz / worldPos.w;
+
+    vec3 norm = decodeNormal(texture(gNormal, uv).rg);
+    vec4 albedo = texture(gAlbedo, uv);
+    // Per-material shininess written by the geometry pass
+    float shininess = exp2(texture(gMaterial, uv).r * 10.0);
+
+    vec3 toLight = lightPos - fragPos;
+    float dist = length(toLight);
+    vec3 lightDir = toLight / max(dist, 1e-4);
+    vec3 viewDir = normalize(viewPos - fragPos);
+
+    // A radius of 0 means the unattenuated, shadowed scene light
+    float falloff = 1.0;
+    if (lightRadius == 0.0) {
+        falloff = shadowFactor(fragPos, norm);
+    } else {
+        falloff = clamp(1.0 - (dist * dist) / (lightRadius * lightRadius), 0.0, 1.0);
+        falloff *= falloff;
+        if (falloff <= 0.0) {
+            discard;
+        }
+    }
+
+    // Ambient
+    vec3 ambient = ambientStrength * lightColor;
+
+    // Diffuse
+    float diff = max(dot(norm, lightDir), 0.0);
+
+    // Specular: 0 = Phong, 1 = Blinn-Phong, 2 = Gaussian
+    float spec;
+    if (specularModel == 0) {
+        vec3 reflectDir = reflect(-lightDir, norm);
+        spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    } else {
+        vec3 halfwayDir = normalize(lightDir + viewDir);
+        float NdotH = max(dot(norm, halfwayDir), 0.0);
+        spec = specularModel == 1 ? pow(NdotH, shininess) : exp(-shininess * (1.0 - NdotH));
+    }
+
+    vec3 result = (ambient + falloff * (diff + albedo.a * spec) * lightColor) * albedo.rgb;
+    FragColor = vec4(result, 1.0);
+}
\ No newline at end of file
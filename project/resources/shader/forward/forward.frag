@@ -0,0 +1,120 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+// Per-view camera, see GLEngine::MultiView
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+uniform vec3 lightPos;
+uniform vec3 lightColor;
+uniform vec3 objectColor;
+// Optional diffuse texture, modulates objectColor
+uniform sampler2D diffuseMap;
+uniform bool useDiffuseMap;
+uniform float shininess;
+uniform float ambientStrength;
+uniform float specularStrength;
+// 0 = Phong, 1 = Blinn-Phong, 2 = Gaussian, as in the deferred pass
+uniform int specularModel;
+
+// Clustered point lights, see GLEngine::ClusteredLights
+uniform samplerBuffer lightData;
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer lightIndices;
+// First texel of this frame's data inside the shared stream buffer
+uniform int lightDataOffset;
+uniform int clusterGridOffset;
+uniform int lightIndicesOffset;
+uniform int pointLightCount;
+uniform ivec3 clusterDims;
+// Bottom-left pixel of the view
+uniform vec2 clusterOrigin;
+uniform vec2 clusterTileSize;
+uniform float clusterZScale;
+uniform float clusterZBias;
+
+// Cached omnidirectional shadow of the scene light, see GLEngine::ShadowCubeMap
+uniform samplerCubeShadow shadowMap;
+uniform bool shadowsEnabled;
+uniform vec2 shadowDepthRange;
+
+vec3 shadeLight(vec3 norm, vec3 viewDir, vec3 lightDir, vec3 color)
+{
+    // Diffuse 
+    float diff = max(dot(norm, lightDir), 0.0);
+    
+    // Specular
+    float spec;
+    if (specularModel == 0) {
+        vec3 reflectDir = reflect(-lightDir, norm);
+        spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    } else {
+        vec3 halfwayDir = normalize(lightDir + viewDir);
+        float NdotH = max(dot(norm, halfwayDir), 0.0);
+        spec = specularModel == 1 ? pow(NdotH, shininess) : exp(-shininess * (1.0 - NdotH));
+    }
+    return (diff + specularStrength * spec) * color;
+}
+
+float shadowFactor(vec3 fragPos, vec3 norm)
+{
+    if (!shadowsEnabled) {
+        return 1.0;
+    }
+
+    // The reference is the cube face depth of the light-to-fragment vector
+    vec3 fromLight = fragPos + norm * 0.01 - lightPos;
+    float localZ = max(abs(fromLight.x), max(abs(fromLight.y), abs(fromLight.z)));
+    float n = shadowDepthRange.x;
+    float f = shadowDepthRange.y;
+    float depth = (f + n) / (f - n) - (2.0 * f * n) / ((f - n) * localZ);
+    return texture(shadowMap, vec4(fromLight, depth * 0.5 + 0.5));
+}
+
+vec3 shadePointLights(vec3 norm, vec3 viewDir)
+{
+    vec3 result = vec3(0.0);
+    float viewZ = -(view * vec4(FragPos, 1.0)).z;
+    ivec3 cluster = ivec3(ivec2((gl_FragCoord.xy - clusterOrigin) / clusterTileSize), int(log(viewZ) * clusterZScale - clusterZBias));
+    cluster = clamp(cluster, ivec3(0), clusterDims - 1);
+    uvec2 cell = texelFetch(clusterGrid, clusterGridOffset + cluster.x + clusterDims.x * (cluster.y + clusterDims.y * cluster.z)).rg;
+
+    for (uint i = 0u; i < cell.y; i++) {
+        int light = int(texelFetch(lightIndices, lightIndicesOffset + int(cell.x + i)).r);
+        vec4 positionRadius = texelFetch(lightData, lightDataOffset + 2 * light);
+        vec4 colorIntensity = texelFetch(lightData, lightDataOffset + 2 * light + 1);
+
+        vec3 toLight = positionRadius.xyz - FragPos;
+        float dist = length(toLight);
+        float falloff = clamp(1.0 - (dist * dist) / (positionRadius.w * positionRadius.w), 0.0, 1.0);
+        falloff *= falloff;
+        result += falloff * colorIntensity.w * shadeLight(norm, viewDir, toLight / max(dist, 1e-4), colorIntensity.rgb);
+    }
+    return result;
+}
+
+void main()
+{
+    // Ambient
+    vec3 ambient = ambientStrength * lightColor;
+
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 lighting = ambient + shadowFactor(FragPos, norm) * shadeLight(norm, viewDir, lightDir, lightColor);
+
+    if (pointLightCount > 0) {
+        lighting += shadePointLights(norm, viewDir);
+    }
+
+    vec3 albedo = useDiffuseMap ? objectColor * texture(diffuseMap, TexCoords).rgb : objectColor;
+    vec3 result = lighting * albedo;
+    FragColor = vec4(result, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#version 330 core
+layout (location = 0) out vec2 gNormal;
+layout (location = 1) out vec4 gAlbedo;
+// log2(shininess) / 10, covers the MTL Ns range
+layout (location = 2) out float gMaterial;
+
+in vec3 Normal;
+in vec2 TexCoords;
+
+uniform vec3 objectColor;
+// Optional diffuse texture, modulates objectColor
+uniform sampler2D diffuseMap;
+uniform bool useDiffuseMap;
+uniform float specularStrength;
+uniform float shininess;
+
+vec2 octWrap(vec2 v)
+{
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// Octahedral normal encoding, remapped to [0, 1] for an RG16 target
+vec2 encodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    n.xy = n.z >= 0.0 ? n.xy : octWrap(n.xy);
+    return n.xy * 0.5 + 0.5;
+}
+
+void main()
+{
+    gNormal = encodeNormal(normalize(Normal));
+    vec3 albedo = useDiffuseMap ? objectColor * texture(diffuseMap, TexCoords).rgb : objectColor;
+    gAlbedo = vec4(albedo, specularStrength);
+    gMaterial = clamp(log2(max(shininess, 1.0)) / 10.0, 0.0, 1.0);
+}
\ No newline at end of file
@@ -5,8 +5,13 @@ layout (location = 1) in vec3 aColor;
 out vec3 Color;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// Per-view camera, see GLEngine::MultiView
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
 
 void main() {
     gl_Position = projection * view * model * vec4(aPos, 1.0);
@@ -2,17 +2,21 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 
-out VS_OUT {
-    vec3 normal;
-} vs_out;
-
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat3 normalMatrix;
 uniform float normalLength;
 
+// Per-view camera, see GLEngine::MultiView
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
+
+// Drawn as GL_LINES instanced once per vertex: gl_VertexID 0 is the base, 1 the tip
 void main() {
     vec3 worldPos = vec3(model * vec4(aPos, 1.0));
-    vs_out.normal = aNormal;
+    vec3 normalDir = normalize(normalMatrix * aNormal);
+    worldPos += normalDir * normalLength * float(gl_VertexID);
     gl_Position = projection * view * vec4(worldPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D sceneTexture;
+// Fraction of the texture covered by the scaled render
+uniform vec2 texCoordScale;
+uniform vec2 texelSize;
+uniform float sharpness;
+
+vec3 fetch(vec2 uv)
+{
+    // Stay inside the rendered region so the unused part never bleeds in
+    return texture(sceneTexture, clamp(uv, texelSize * 0.5, texCoordScale - texelSize * 0.5)).rgb;
+}
+
+void main()
+{
+    vec2 uv = TexCoords * texCoordScale;
+    vec3 center = fetch(uv);
+    if (sharpness <= 0.0) {
+        FragColor = vec4(center, 1.0);
+        return;
+    }
+
+    // Unsharp mask over the source texel neighbourhood
+    vec3 north = fetch(uv + vec2(0.0, texelSize.y));
+    vec3 south = fetch(uv - vec2(0.0, texelSize.y));
+    vec3 east = fetch(uv + vec2(texelSize.x, 0.0));
+    vec3 west = fetch(uv - vec2(texelSize.x, 0.0));
+    vec3 sharpened = center + sharpness * (4.0 * center - north - south - east - west) * 0.25;
+
+    // Clamping to the local range avoids halos around edges
+    vec3 minColor = min(center, min(min(north, south), min(east, west)));
+    vec3 maxColor = max(center, max(max(north, south), max(east, west)));
+    FragColor = vec4(clamp(sharpened, minColor, maxColor), 1.0);
+}
\ No newline at end of file
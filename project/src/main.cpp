@@ -9,6 +9,18 @@
 
 #include <iostream>
 #include <vector>
+#include <random>
+#include <ctime>
+#include <cstring>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <iomanip>
 
 #include "project/config.hpp"
 #include <glengine/shader.hpp>
@@ -17,6 +29,31 @@
 #include <glengine/mesh.hpp>
 #include <glengine/grid3D.hpp>
 #include <glengine/cube.hpp>
+#include <glengine/scene.hpp>
+#include <glengine/redrawScheduler.hpp>
+#include <glengine/clusteredLights.hpp>
+#include <glengine/gbuffer.hpp>
+#include <glengine/shadowCubeMap.hpp>
+#include <glengine/depthPrepass.hpp>
+#include <glengine/dynamicResolution.hpp>
+#include <glengine/frameCapture.hpp>
+#include <glengine/videoStream.hpp>
+#include <glengine/textureCache.hpp>
+#include <glengine/renderQueue.hpp>
+#include <glengine/stateCache.hpp>
+#include <glengine/jobSystem.hpp>
+#include <glengine/frameArena.hpp>
+#include <glengine/geometryPool.hpp>
+#include <glengine/streamBuffer.hpp>
+#include <glengine/session.hpp>
+#include <glengine/glStats.hpp>
+#include <glengine/allocStats.hpp>
+#include <glengine/gpuMemory.hpp>
+#include <glengine/meshResidency.hpp>
+#include <glengine/multiView.hpp>
+#include <glengine/renderThread.hpp>
+#include <glengine/tripleBuffer.hpp>
+#include <glengine/trace.hpp>
 
 const unsigned int SCR_WIDTH = 1920;
 const unsigned int SCR_HEIGHT = 1080;
@@ -32,18 +69,216 @@ enum class LightingMode {
     NONE,
     PHONG,
     BLINN_PHONG,
-    GAUSSIAN
+    GAUSSIAN,
+    DEFERRED_PHONG,
+    DEFERRED_BLINN_PHONG,
+    DEFERRED_GAUSSIAN
+};
+enum RenderPass : unsigned int {
+    RENDER_PASS_GBUFFER,
+    RENDER_PASS_FORWARD,
+    RENDER_PASS_COUNT
+};
+// Each view of a pass is its own range of the render queue
+constexpr unsigned int viewPass(unsigned int pass, unsigned int view) {
+    return pass * GLEngine::MultiView::MAX_VIEWS + view;
+}
+static_assert(RENDER_PASS_COUNT * GLEngine::MultiView::MAX_VIEWS <= GLEngine::RenderQueue::MAX_PASSES,
+    "too many views for the render queue passes");
+struct JobBenchmarkResult {
+    unsigned int threads;
+    double ms;
+    double utilization;
+    unsigned long long steals;
+};
+
+// Values edited by the UI and recorded by the session; the render thread compares them with the ones it applied
+struct FrameParameters {
+    float backgroundColor[3] = {0.2f, 0.3f, 0.3f};
+    bool showGrid = true;
+    LightingMode lightingMode = LightingMode::PHONG;
+    float lightPosition[3] = {3.0f, 1.0f, 3.0f};
+    float lightColor[3] = {1.0f, 1.0f, 1.0f};
+    float ambientStrength = 0.1f;
+    float specularStrength = 0.5f;
+    float shininess = 256.0f;
+    bool showShadows = true;
+    bool showAllModels = false;
+    bool showWireframe = false;
+    float objectColor[3] = {0.8f, 0.8f, 0.8f};
+    char diffuseTexture[256] = "";
+    bool showNormals = false;
+    float normalLength = 0.1f;
+    int normalStep = 1;
+    bool persistentStreamMapping = true;
+    int textureBudgetMB = 512;
+    int depthPrepassMode = 0;
+    float depthPrepassThreshold = 0.0f;
+    bool dynamicResolution = false;
+    float resolutionScale = 1.0f;
+    float gpuBudget = 0.0f;
+    float upscaleSharpness = 0.0f;
+    int viewLayout = 0;
+    int captureFormat = 0;
+    bool recordFrames = false;
+    bool streaming = false;
+    char streamPath[256] = "captures/stream.y4m";
+};
+
+// ImGui reuses its draw lists on the next NewFrame, the render thread draws from this copy
+struct UiDrawData {
+    ImDrawData data;
+    std::vector<std::unique_ptr<ImDrawList>> lists;
+};
+
+// Everything one frame is drawn from, filled by the main thread and read-only once published
+struct FrameSnapshot {
+    uint64_t frame = 0;
+    int width = 0;
+    int height = 0;
+    // One per view of parameters.viewLayout
+    GLEngine::OrbitalCamera cameras[GLEngine::MultiView::MAX_VIEWS];
+    FrameParameters parameters;
+    std::string modelPath;
+    std::vector<GLEngine::PointLight> lights;
+    // Requests are running counts, a snapshot never drawn cannot lose one
+    uint64_t screenshots = 0;
+    std::string screenshotPath;
+    std::string recordingPath;
+    uint64_t defragmentations = 0;
+    UiDrawData ui;
+};
+
+// What the UI shows of the render thread's objects, copied after each drawn frame
+struct RenderStats {
+    uint64_t frame = 0;
+    double cpuMs = 0.0;
+    float gpuMs = 0.0f;
+    uint64_t shadowMapRenders = 0;
+    unsigned int clusterCount = 0;
+    size_t lightIndexCount = 0;
+    unsigned int maxLightsPerCluster = 0;
+    size_t subMeshes = 0;
+    size_t materials = 0;
+    size_t vertexCount = 0;
+    bool depthPrepassActive = false;
+    float depthComplexity = 0.0f;
+    float shadedFragmentsPerPixel = 0.0f;
+    uint64_t shadedFragments = 0;
+    float resolutionScale = 1.0f;
+    int renderWidth = 0;
+    int renderHeight = 0;
+    GLEngine::RenderQueue::Stats queue;
+    unsigned int recorderCount = 0;
+    unsigned int viewCount = 0;
+    size_t visibleRenderables[GLEngine::MultiView::MAX_VIEWS] = {};
+    double traversalMs = 0.0;
+    GLEngine::FrameArena::Stats arena;
+    GLEngine::GLStats::Counters gl;
+    uint64_t jobsExecuted = 0;
+    uint64_t jobsStolen = 0;
+    GLEngine::GeometryPool::Stats pool;
+    float poolFragmentation = 0.0f;
+    GLEngine::StreamBuffer::Stats stream;
+    unsigned int streamRegionCount = 0;
+    size_t streamRegionSize = 0;
+    size_t textureCount = 0;
+    size_t residentTextures = 0;
+    size_t pendingTextures = 0;
+    size_t textureMemory = 0;
+    size_t textureUploaded = 0;
+    uint64_t textureDecodes = 0;
+    uint64_t textureDuplicates = 0;
+    uint64_t textureEvictions = 0;
+    size_t meshCount = 0;
+    size_t evictedMeshes = 0;
+    uint64_t meshEvictions = 0;
+    uint64_t meshRestores = 0;
+    bool driverMemory = false;
+    GLEngine::GpuMemory::DriverInfo driver;
+    uint64_t capturedFrames = 0;
+    uint64_t encodedFrames = 0;
+    uint64_t droppedFrames = 0;
+    uint64_t failedFrames = 0;
+    size_t pendingEncodes = 0;
+    bool videoStreaming = false;
+    int videoWidth = 0;
+    int videoHeight = 0;
+    uint64_t videoWritten = 0;
+    uint64_t videoDropped = 0;
+    double videoThroughput = 0.0;
+    float videoConvertMs = 0.0f;
+    bool videoError = false;
 };
 
 MousePressedButton mouseButtonState = MousePressedButton::NONE;
 
 GLEngine::OrbitalCamera orbitalCamera(glm::vec3(0.3f, 0.4f, 3.0f), glm::vec3(0.0, 0.0, 0.0), glm::vec3(0.0, 1.0, 0.0));
+GLEngine::RedrawScheduler redrawScheduler;
+GLEngine::Session session;
+
+void generatePointLights(std::vector<GLEngine::PointLight>& lights, int count, float radius);
+void copyDrawData(const ImDrawData& source, UiDrawData& target);
+std::string captureTimestamp();
+std::vector<JobBenchmarkResult> runJobBenchmark(unsigned int maxThreads);
 
 void onMouseButton(GLFWwindow* window, int button, int action, int mods);
 void onMouseMove(GLFWwindow* window, double xpos, double ypos);
 void onMouseScroll(GLFWwindow* window, double xoffset, double yoffset);
+void onKey(GLFWwindow* window, int key, int scancode, int action, int mods);
+void onFramebufferSize(GLFWwindow* window, int width, int height);
+void onWindowRefresh(GLFWwindow* window);
+
+int main(int argc, char** argv) {
+    // --y4m <path> streams every frame as YUV4MPEG2, "-" for stdout
+    // --record <path> records the session, --replay <path> replays it hidden at the recorded pace,
+    // --replay-fast <path> as fast as possible, --timings <path> writes the replayed frame times as CSV
+    // --trace <path> writes the CPU trace zones as Chrome trace JSON at exit (GLENGINE_TRACE builds)
+    // --benchmark <path> writes frame time percentiles, GL and heap counters as JSON at exit
+    // --alloc-check <frames> fails the run when a frame allocates once <frames> frames have passed since
+    // startup or the last parameter change (GLENGINE_ALLOC_STATS builds, typically with --replay-fast)
+    std::string y4mPath;
+    std::string recordPath;
+    std::string replayPath;
+    std::string timingsPath;
+    std::string tracePath;
+    std::string benchmarkPath;
+    bool replayFast = false;
+    int allocCheckFrames = -1;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], "--y4m") == 0) {
+            y4mPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--record") == 0) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 || std::strcmp(argv[i], "--replay-fast") == 0) {
+            replayFast = std::strcmp(argv[i], "--replay-fast") == 0;
+            replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--timings") == 0) {
+            timingsPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--trace") == 0) {
+            tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--benchmark") == 0) {
+            benchmarkPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--alloc-check") == 0) {
+            allocCheckFrames = std::max(std::atoi(argv[++i]), 0);
+        }
+    }
+    if (allocCheckFrames >= 0 && !GLEngine::AllocStats::isEnabled()) {
+        std::cerr << "ERROR::ALLOC::CHECK_UNAVAILABLE: build with GLENGINE_ALLOC_STATS" << std::endl;
+        return -1;
+    }
+    if (!replayPath.empty() && !session.startReplay(replayPath)) {
+        return -1;
+    }
+    if (y4mPath == "-") {
+        // Keep log output out of the video stream
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    // Events, camera and UI; the GL context moves to the render thread once everything is loaded
+    GLENGINE_TRACE_THREAD("Main Thread");
+    GLEngine::AllocStats::setThreadName("Main Thread");
 
-int main() {
     // Initialize GLFW
     if (!glfwInit()) {
         std::cout << "Failed to initialize GLFW" << std::endl;
@@ -58,8 +293,17 @@ int main() {
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
+    // A replay renders offscreen at the recorded framebuffer size
+    int windowWidth = SCR_WIDTH;
+    int windowHeight = SCR_HEIGHT;
+    if (session.isReplaying()) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        windowWidth = session.getWidth();
+        windowHeight = session.getHeight();
+    }
+
     // Create window
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "OpenGL - Demonstrator", NULL, NULL);
+    GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "OpenGL - Demonstrator", NULL, NULL);
     if (window == NULL) {
         std::cout << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -67,24 +311,48 @@ int main() {
     }
 
     glfwMakeContextCurrent(window);
+    if (session.isReplaying() && replayFast) {
+        glfwSwapInterval(0);
+    }
 
     // Initialize GLAD
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    GLEngine::StreamBuffer::loadExtensions((GLADloadproc)glfwGetProcAddress);
+    // ImGui loads its own GL pointers, so its draws stay out of the counters
+    GLEngine::GLStats::install();
 
     // Configure global OpenGL state
     glEnable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    orbitalCamera.setClipPlanes(NEAR_PLANE, FAR_PLANE);
 
     // Set callbacks
-    glfwSetFramebufferSizeCallback(window, GLEngine::framebufferSizeCallback);
+    glfwSetFramebufferSizeCallback(window, onFramebufferSize);
+    glfwSetWindowRefreshCallback(window, onWindowRefresh);
     glfwSetMouseButtonCallback(window, onMouseButton);
     glfwSetCursorPosCallback(window, onMouseMove);
     glfwSetScrollCallback(window, onMouseScroll);
+    glfwSetKeyCallback(window, onKey);
 
     // Initialize ImGui
     IMGUI_CHECKVERSION();
+    if (GLEngine::AllocStats::isEnabled()) {
+        // ImGui allocates with malloc, routed through the counters so the UI is not invisible to them
+        ImGui::SetAllocatorFunctions(
+            [](size_t size, void*) {
+                GLEngine::AllocStats::onAllocate(size);
+                return std::malloc(size);
+            },
+            [](void* pointer, void*) {
+                if (pointer) {
+                    GLEngine::AllocStats::onFree();
+                }
+                std::free(pointer);
+            });
+    }
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
@@ -101,175 +369,830 @@ int main() {
 
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init();
+    // Shaders and font texture now, ImGui_ImplOpenGL3_NewFrame would create them lazily on the UI thread
+    ImGui_ImplOpenGL3_CreateDeviceObjects();
 
     // Load and compile shaders
     std::string basicVertPath = std::string(_resources_directory).append("shader/basic/basic.vert");
     std::string basicFragPath = std::string(_resources_directory).append("shader/basic/basic.frag");
     GLEngine::Shader basicShader(basicVertPath.c_str(), basicFragPath.c_str());
 
-    std::string phongVertPath = std::string(_resources_directory).append("shader/phong/phong.vert");
-    std::string phongFragPath = std::string(_resources_directory).append("shader/phong/phong.frag");
-    GLEngine::Shader phongShader(phongVertPath.c_str(), phongFragPath.c_str());
-
-    std::string blinnPhongVertPath = std::string(_resources_directory).append("shader/blinn-phong/blinn-phong.vert");
-    std::string blinnPhongFragPath = std::string(_resources_directory).append("shader/blinn-phong/blinn-phong.frag");
-    GLEngine::Shader blinnPhongShader(blinnPhongVertPath.c_str(), blinnPhongFragPath.c_str());
-
-    std::string gaussianVertPath = std::string(_resources_directory).append("shader/gaussian/gaussian.vert");
-    std::string gaussianFragPath = std::string(_resources_directory).append("shader/gaussian/gaussian.frag");
-    GLEngine::Shader gaussianShader(gaussianVertPath.c_str(), gaussianFragPath.c_str());
+    // Phong, Blinn-Phong and Gaussian lighting, the specular model is a uniform
+    std::string forwardVertPath = std::string(_resources_directory).append("shader/forward/forward.vert");
+    std::string forwardFragPath = std::string(_resources_directory).append("shader/forward/forward.frag");
+    GLEngine::Shader forwardShader(forwardVertPath.c_str(), forwardFragPath.c_str());
 
     std::string gridVertPath = std::string(_resources_directory).append("shader/grid/grid.vert");
     std::string gridFragPath = std::string(_resources_directory).append("shader/grid/grid.frag");
     GLEngine::Shader gridShader(gridVertPath.c_str(), gridFragPath.c_str());
 
     std::string normalVertPath = std::string(_resources_directory).append("shader/normal/normal.vert");
-    std::string normalGeomPath = std::string(_resources_directory).append("shader/normal/normal.geom");
     std::string normalFragPath = std::string(_resources_directory).append("shader/normal/normal.frag");
-    GLEngine::Shader normalShader(normalVertPath.c_str(), normalGeomPath.c_str(), normalFragPath.c_str());
+    GLEngine::Shader normalShader(normalVertPath.c_str(), normalFragPath.c_str());
 
     std::string lightVertPath = std::string(_resources_directory).append("shader/light/light.vert");
     std::string lightFragPath = std::string(_resources_directory).append("shader/light/light.frag");
     GLEngine::Shader lightShader(lightVertPath.c_str(), lightFragPath.c_str());
 
+    std::string gbufferVertPath = std::string(_resources_directory).append("shader/gbuffer/gbuffer.vert");
+    std::string gbufferFragPath = std::string(_resources_directory).append("shader/gbuffer/gbuffer.frag");
+    GLEngine::Shader gbufferShader(gbufferVertPath.c_str(), gbufferFragPath.c_str());
+
+    std::string deferredVertPath = std::string(_resources_directory).append("shader/deferred/deferred.vert");
+    std::string deferredFragPath = std::string(_resources_directory).append("shader/deferred/deferred.frag");
+    GLEngine::Shader deferredShader(deferredVertPath.c_str(), deferredFragPath.c_str());
+
+    std::string shadowVertPath = std::string(_resources_directory).append("shader/shadow/shadow.vert");
+    std::string shadowFragPath = std::string(_resources_directory).append("shader/shadow/shadow.frag");
+    GLEngine::Shader shadowShader(shadowVertPath.c_str(), shadowFragPath.c_str());
+
+    std::string prepassVertPath = std::string(_resources_directory).append("shader/prepass/prepass.vert");
+    std::string prepassFragPath = std::string(_resources_directory).append("shader/prepass/prepass.frag");
+    GLEngine::Shader prepassShader(prepassVertPath.c_str(), prepassFragPath.c_str());
+
+    std::string upscaleVertPath = std::string(_resources_directory).append("shader/upscale/upscale.vert");
+    std::string upscaleFragPath = std::string(_resources_directory).append("shader/upscale/upscale.frag");
+    GLEngine::Shader upscaleShader(upscaleVertPath.c_str(), upscaleFragPath.c_str());
+
+    // Scene shaders read their view and projection from the camera block of the view being drawn
+    for (const GLEngine::Shader* shader : { &basicShader, &forwardShader, &gridShader, &normalShader, &lightShader,
+        &gbufferShader, &prepassShader }) {
+        shader->bindUniformBlock("Camera", GLEngine::MultiView::CAMERA_BINDING);
+    }
+
     std::string objectsDir = std::string(_resources_directory).append("object/");
     std::vector<std::string> objFiles = GLEngine::Mesh::getObjFiles(objectsDir);
-    
+
     static int currentItem = 0;
     std::string currentObjPath = objectsDir + objFiles[currentItem];
+    // Every model shares the pool's buffers, so all of them draw from a single VAO
+    GLEngine::GeometryPool geometryPool;
     GLEngine::Mesh currentMesh;
-    currentMesh.loadFromFile(currentObjPath);
+    currentMesh.loadFromFile(currentObjPath, geometryPool);
 
     GLEngine::Grid3D grid(1.0f, 0.2f);
     GLEngine::Cube lightCube(0.1f);
     GLEngine::Shader objectShader = basicShader;
 
-    static float lightPos[3] = {3.0f, 1.0f, 3.0f};
-    static float objectColor[3] = {0.8f, 0.8f, 0.8f};
-    static float lightColor[3] = {1.0f, 1.0f, 1.0f};
-    static float shininess = 256.0f;
-    static float ambientStrength = 0.1f;
-    static float specularStrength = 0.5f;
-    static float backgroundColor[3] = {0.2f, 0.3f, 0.3f};
-    static bool showWireframe = false;
-    static bool showGrid = true;
-    static bool showNormals = false;
-    static float normalLength = 0.1f;
+    // Main thread state; the render thread only sees the copies published with each frame
+    FrameParameters parameters;
+    // Orthographic views of the quad layout, aimed at the focus of the perspective camera every frame
+    GLEngine::OrbitalCamera topCamera(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    GLEngine::OrbitalCamera frontCamera(glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    GLEngine::OrbitalCamera sideCamera(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    GLEngine::Scene scene;
+    GLEngine::Scene::NodeId objectNode = scene.createNode();
+    GLEngine::Scene::NodeId lightNode = scene.createNode(GLEngine::Scene::INVALID_NODE,
+        glm::translate(glm::mat4(1.0f), glm::vec3(parameters.lightPosition[0], parameters.lightPosition[1],
+            parameters.lightPosition[2])));
+    static char diffuseTextureInput[256] = "";
     static LightingMode currentLightingMode = LightingMode::PHONG;
+    static bool renderOnDemand = false;
+    static int pointLightCount = 0;
+    static float pointLightRadius = 0.4f;
+    static bool animatePointLights = false;
+    static int gpuBudgetMB = 0;
+    std::vector<GLEngine::GpuMemory::Resource> gpuResources;
+    static std::vector<JobBenchmarkResult> jobBenchmark;
+    uint64_t screenshotRequests = 0;
+    std::string screenshotPath;
+    std::string recordingPath;
+    uint64_t defragmentRequests = 0;
 
-    while (!glfwWindowShouldClose(window)) {
-        GLEngine::processInput(window);
+    // Scene traversal and draw recording run as jobs, one recorder per job thread
+    GLEngine::JobSystem jobSystem;
+#ifdef GLENGINE_TRACE
+    // Jobs show up on the timeline of the thread that ran them
+    jobSystem.setTraceHook([](const char* name, unsigned int, uint64_t start, uint64_t end, void*) {
+        GLEngine::Trace::recordNanoseconds(name ? name : "job", start, end);
+    });
+#endif
+    const unsigned int jobThreadCount = jobSystem.getThreadCount();
+    // Transient per-frame data (draw packets, culling results, light ranges), one sub-arena per job thread
+    GLEngine::FrameArena frameArena(jobThreadCount);
 
-        std::vector<std::string> objFiles = GLEngine::Mesh::getObjFiles(objectsDir);
-        
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+    GLEngine::ClusteredLights clusteredLights(16, 9, 24, &frameArena);
+    std::vector<GLEngine::PointLight> pointLights;
+    GLEngine::GBuffer gbuffer;
+    GLEngine::ShadowCubeMap shadowMap;
+    GLEngine::DepthPrepass depthPrepass;
+    GLEngine::DynamicResolution dynamicResolution;
+    GLEngine::FrameCapture frameCapture;
+    GLEngine::VideoStream videoStream;
+    GLEngine::TextureCache textureCache;
+    GLEngine::TextureCache::Handle diffuseTexture = GLEngine::TextureCache::INVALID_HANDLE;
+    GLEngine::RenderQueue renderQueue(jobThreadCount, &frameArena);
+    GLEngine::StateCache stateCache;
+    GLEngine::StreamBuffer streamBuffer;
+    GLEngine::MultiView multiView;
+    currentMesh.loadTextures(textureCache);
+
+    parameters.depthPrepassMode = (int)depthPrepass.getMode();
+    parameters.depthPrepassThreshold = depthPrepass.getThreshold();
+    parameters.dynamicResolution = dynamicResolution.isAutoScale();
+    parameters.resolutionScale = dynamicResolution.getScale();
+    parameters.gpuBudget = dynamicResolution.getBudget();
+    parameters.upscaleSharpness = dynamicResolution.getSharpness();
+    const float minResolutionScale = dynamicResolution.getMinScale();
+    const float maxResolutionScale = dynamicResolution.getMaxScale();
+
+    // Every bundled model side by side, loaded on first use
+    std::vector<std::unique_ptr<GLEngine::Mesh>> galleryMeshes;
+    std::vector<GLEngine::Scene::NodeId> galleryNodes;
+    std::vector<std::pair<GLEngine::Mesh*, GLEngine::Scene::NodeId>> renderables;
+    // Bit v: seen by view v; CASTS_SHADOW: within reach of the shadow map
+    std::pmr::vector<uint8_t> renderableVisible(frameArena.getResource());
+    constexpr uint8_t CASTS_SHADOW = 0x80;
+    static_assert(GLEngine::MultiView::MAX_VIEWS < 8, "view bits overlap CASTS_SHADOW");
+    uint64_t geometryRevision = 0;
+    // Over the GPU memory budget, meshes out of view the longest give their geometry back
+    GLEngine::MeshResidency meshResidency(geometryPool);
+    meshResidency.add(&currentMesh);
+
+    // Frames go to the render thread, the counters of each drawn frame come back for the UI
+    GLEngine::TripleBuffer<FrameSnapshot> snapshots;
+    GLEngine::TripleBuffer<RenderStats> renderStats;
+    GLEngine::RenderThread renderThread;
+    // Render thread: the frame being drawn
+    const FrameSnapshot* drawnFrame = nullptr;
+
+    // Per-material uniforms, shared by the forward shaders and the G-buffer pass; wrapped once,
+    // the captures do not fit in a std::function built per call and would be heap allocated every pass
+    const GLEngine::RenderQueue::MaterialSetup applyMaterial = [&](const GLEngine::Shader& shader, const GLEngine::Material& material) {
+        const FrameParameters& params = drawnFrame->parameters;
+        shader.setVec3("objectColor", glm::vec3(params.objectColor[0], params.objectColor[1], params.objectColor[2]) *
+            material.diffuse);
+        shader.setFloat("specularStrength", params.specularStrength * material.specular);
+        shader.setFloat("shininess", material.shininess > 0.0f ? material.shininess : params.shininess);
+
+        // A map from the MTL file wins over the one picked in the UI
+        GLEngine::TextureCache::Handle diffuseMap = material.diffuseMap != GLEngine::TextureCache::INVALID_HANDLE
+            ? material.diffuseMap : diffuseTexture;
+        textureCache.bind(diffuseMap, 4);
+        shader.setInt("diffuseMap", 4);
+        shader.setBool("useDiffuseMap", diffuseMap != GLEngine::TextureCache::INVALID_HANDLE);
+    };
+    // Shadow casters, handed to the shadow map by reference for the same reason
+    const std::function<void(const glm::mat4&)> drawShadowCasters = [&](const glm::mat4& lightViewProjection) {
+        shadowShader.use();
+        shadowShader.setMat4("lightViewProjection", lightViewProjection);
+        for (const auto& renderable : renderables) {
+            shadowShader.setMat4("model", scene.getWorldMatrix(renderable.second));
+            renderable.first->draw();
+        }
+    };
+
+    // Records every renderable for one pass of each view, sorted front to back within each material;
+    // the scene is walked once, each world box is culled against all views in one test
+    size_t visibleRenderables[GLEngine::MultiView::MAX_VIEWS] = {};
+    double traversalMs = 0.0;
+    // Light position and range of the shadow map this frame, no range without shadows
+    glm::vec3 shadowLight(0.0f);
+    float shadowReach = 0.0f;
+    auto recordScene = [&](unsigned int pass, const GLEngine::Shader& shader) {
+        GLENGINE_TRACE_ZONE("recordScene");
+        auto start = std::chrono::steady_clock::now();
+        auto recordRange = [&](GLEngine::RenderQueue::Recorder& recorder, size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                const GLEngine::Mesh& mesh = *renderables[i].first;
+                const glm::mat4& world = scene.getWorldMatrix(renderables[i].second);
+                glm::vec3 center = (mesh.getBoundsMin() + mesh.getBoundsMax()) * 0.5f;
+
+                // World-space box around the transformed local bounds
+                glm::vec3 extents = (mesh.getBoundsMax() - mesh.getBoundsMin()) * 0.5f;
+                glm::vec3 worldCenter = glm::vec3(world * glm::vec4(center, 1.0f));
+                glm::mat3 absolute = glm::mat3(world);
+                for (int column = 0; column < 3; column++) {
+                    absolute[column] = glm::abs(absolute[column]);
+                }
+                glm::vec3 worldExtents = absolute * extents;
+                uint32_t views = multiView.cull(worldCenter - worldExtents, worldCenter + worldExtents);
+                // A caster out of view may still shadow it, so it stays resident as well
+                glm::vec3 lightGap = glm::max(glm::abs(worldCenter - shadowLight) - worldExtents, glm::vec3(0.0f));
+                bool castsShadow = shadowReach > 0.0f && glm::dot(lightGap, lightGap) <= shadowReach * shadowReach;
+                if (views == 0 && !castsShadow) {
+                    continue;
+                }
+                // Evicted geometry comes back once the residency update sees it in view or near the light
+                renderableVisible[i] = (uint8_t)(views | (castsShadow ? CASTS_SHADOW : 0));
+                if (!mesh.isResident()) {
+                    continue;
+                }
 
-        glClearColor(backgroundColor[0], backgroundColor[1], backgroundColor[2], 1.0f);
+                const glm::mat3& normalMatrix = scene.getNormalMatrix(renderables[i].second);
+                for (unsigned int v = 0; views != 0; v++, views >>= 1) {
+                    if (views & 1) {
+                        recorder.submit(viewPass(pass, v), shader, mesh, world, normalMatrix,
+                            multiView.getDepth(v, worldCenter));
+                    }
+                }
+            }
+        };
+
+        renderQueue.clear();
+        GLEngine::FrameArena::recycle(renderableVisible);
+        renderableVisible.assign(renderables.size(), 0);
+        // Small scenes stay on the GL thread, waking the workers would cost more
+        jobSystem.parallelFor(renderables.size(), [&](size_t first, size_t last) {
+            recordRange(renderQueue.getRecorder(jobSystem.getThreadIndex()), first, last);
+        }, 256, "recordScene");
+        renderQueue.sort(&jobSystem);
+        std::fill(std::begin(visibleRenderables), std::end(visibleRenderables), 0);
+        for (size_t i = 0; i < renderables.size(); i++) {
+            if (renderableVisible[i]) {
+                meshResidency.markVisible(renderables[i].first);
+                for (unsigned int v = 0; v < multiView.getViewCount(); v++) {
+                    visibleRenderables[v] += (renderableVisible[i] >> v) & 1;
+                }
+            }
+        }
+        traversalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    // Side effects of the UI, also run when a replayed session changes the value
+    auto applyPointLights = [&]() {
+        generatePointLights(pointLights, pointLightCount, pointLightRadius);
+    };
+    auto applyModel = [&]() {
+        if (currentItem >= 0 && (size_t)currentItem < objFiles.size()) {
+            currentObjPath = objectsDir + objFiles[currentItem];
+        }
+    };
+    auto applyLightingMode = [&]() {
+        parameters.lightingMode = currentLightingMode;
+    };
+
+    // Everything a session records besides the camera, matched by name on replay
+    session.bind("backgroundColor", parameters.backgroundColor);
+    session.bind("showGrid", parameters.showGrid);
+    session.bind("viewLayout", parameters.viewLayout);
+    session.bind("lightingMode", currentLightingMode, applyLightingMode);
+    session.bind("lightPosition", parameters.lightPosition);
+    session.bind("lightColor", parameters.lightColor);
+    session.bind("ambientStrength", parameters.ambientStrength);
+    session.bind("specularStrength", parameters.specularStrength);
+    session.bind("shininess", parameters.shininess);
+    session.bind("showShadows", parameters.showShadows);
+    session.bind("pointLightCount", pointLightCount, applyPointLights);
+    session.bind("pointLightRadius", pointLightRadius, applyPointLights);
+    session.bind("animatePointLights", animatePointLights);
+    session.bind("model", currentItem, applyModel);
+    session.bind("showAllModels", parameters.showAllModels);
+    session.bind("showWireframe", parameters.showWireframe);
+    session.bind("objectColor", parameters.objectColor);
+    session.bind("diffuseTexture", parameters.diffuseTexture);
+    session.bind("showNormals", parameters.showNormals);
+    session.bind("normalLength", parameters.normalLength);
+    session.bind("normalStep", parameters.normalStep);
+    session.bind("renderOnDemand", renderOnDemand, [&]() { redrawScheduler.setEnabled(renderOnDemand); });
+    session.bind("persistentStreamMapping", parameters.persistentStreamMapping);
+    session.bind("textureBudget", parameters.textureBudgetMB);
+    session.bind("gpuMemoryBudget", gpuBudgetMB, [&]() { GLEngine::GpuMemory::setBudget((size_t)gpuBudgetMB << 20); });
+    session.bind("depthPrepassMode", parameters.depthPrepassMode);
+    session.bind("depthPrepassThreshold", parameters.depthPrepassThreshold);
+    // The controller depends on measured GPU time: a replay plays back the recorded scales instead
+    session.bind("dynamicResolution", parameters.dynamicResolution, [&]() { parameters.dynamicResolution = false; });
+    session.bind("resolutionScale", parameters.resolutionScale);
+    session.bind("gpuBudget", parameters.gpuBudget);
+    session.bind("upscaleSharpness", parameters.upscaleSharpness);
+
+    if (!recordPath.empty()) {
+        int fbWidth, fbHeight;
+        glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+        session.startRecording(recordPath, orbitalCamera, fbWidth, fbHeight);
+    }
+    const bool replaying = session.isReplaying();
+    if (replaying) {
+        parameters.dynamicResolution = false;
+    }
+    uint64_t allocCheckChanges = 0;
+    int allocCheckSettled = 0;
+    uint64_t allocCheckedFrames = 0;
+    uint64_t allocCheckFailures = 0;
+    std::chrono::steady_clock::time_point replayStart;
+    double replayFirstTime = 0.0;
+
+    if (!y4mPath.empty()) {
+        int fbWidth, fbHeight;
+        glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+        videoStream.start(y4mPath, fbWidth, fbHeight);
+        parameters.streaming = videoStream.isStreaming();
+    }
+
+    // Render thread: what it last applied from the parameters, changes run the matching side effects
+    FrameParameters applied = parameters;
+    std::string appliedModelPath = currentObjPath;
+    uint64_t appliedScreenshots = 0;
+    uint64_t appliedDefragmentations = 0;
+    auto applyParameters = [&](const FrameSnapshot& frame) {
+        GLENGINE_TRACE_ZONE("applyParameters");
+        const FrameParameters& params = frame.parameters;
+        if (frame.modelPath != appliedModelPath) {
+            currentMesh.loadFromFile(frame.modelPath, geometryPool);
+            currentMesh.loadTextures(textureCache);
+            appliedModelPath = frame.modelPath;
+            geometryRevision++;
+            redrawScheduler.invalidateAsync(GLEngine::RedrawScheduler::Source::RESOURCE);
+        }
+        if (params.showAllModels != applied.showAllModels) {
+            // Each model is scaled to a unit box and placed on a row along X
+            if (params.showAllModels && galleryMeshes.empty()) {
+                std::vector<std::string> files = GLEngine::Mesh::getObjFiles(objectsDir);
+                for (size_t i = 0; i < files.size(); i++) {
+                    galleryMeshes.push_back(std::make_unique<GLEngine::Mesh>());
+                    GLEngine::Mesh& mesh = *galleryMeshes.back();
+                    mesh.loadFromFile(objectsDir + files[i], geometryPool);
+                    mesh.loadTextures(textureCache);
+                    meshResidency.add(&mesh);
+
+                    glm::vec3 extent = mesh.getBoundsMax() - mesh.getBoundsMin();
+                    glm::vec3 center = (mesh.getBoundsMax() + mesh.getBoundsMin()) * 0.5f;
+                    float size = std::max(extent.x, std::max(extent.y, extent.z));
+                    float x = ((float)i - (float)(files.size() - 1) * 0.5f) * 1.25f;
+                    glm::mat4 local = glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, 0.0f));
+                    local = glm::scale(local, glm::vec3(size > 0.0f ? 1.0f / size : 1.0f));
+                    local = glm::translate(local, -center);
+                    galleryNodes.push_back(scene.createNode(objectNode, local));
+                }
+            }
+            geometryRevision++;
+        }
+        if (std::memcmp(params.lightPosition, applied.lightPosition, sizeof(params.lightPosition)) != 0) {
+            scene.setLocalTransform(lightNode, glm::translate(glm::mat4(1.0f),
+                glm::vec3(params.lightPosition[0], params.lightPosition[1], params.lightPosition[2])));
+        }
+        if (std::strcmp(params.diffuseTexture, applied.diffuseTexture) != 0) {
+            diffuseTexture = params.diffuseTexture[0] != '\0'
+                ? textureCache.load(params.diffuseTexture) : GLEngine::TextureCache::INVALID_HANDLE;
+        }
+        if (params.persistentStreamMapping != applied.persistentStreamMapping) {
+            streamBuffer.setPersistentMapping(params.persistentStreamMapping);
+        }
+        if (params.textureBudgetMB != applied.textureBudgetMB) {
+            textureCache.setGpuBudget((size_t)params.textureBudgetMB << 20);
+        }
+        depthPrepass.setMode((GLEngine::DepthPrepass::Mode)params.depthPrepassMode);
+        depthPrepass.setThreshold(params.depthPrepassThreshold);
+        dynamicResolution.setAutoScale(params.dynamicResolution);
+        dynamicResolution.setBudget(params.gpuBudget);
+        dynamicResolution.setSharpness(params.upscaleSharpness);
+        // While the controller runs, the scale in the parameters is the one it reported
+        if (!params.dynamicResolution && params.resolutionScale != dynamicResolution.getScale()) {
+            dynamicResolution.setScale(params.resolutionScale);
+        }
+
+        if (params.recordFrames != applied.recordFrames) {
+            if (params.recordFrames) {
+                frameCapture.startRecording(frame.recordingPath, (GLEngine::FrameCapture::Format)params.captureFormat);
+            } else {
+                frameCapture.stopRecording();
+            }
+        }
+        if (params.streaming != applied.streaming) {
+            if (params.streaming) {
+                videoStream.start(params.streamPath, frame.width, frame.height);
+            } else {
+                videoStream.stop();
+            }
+        }
+        if (frame.screenshots != appliedScreenshots) {
+            frameCapture.requestScreenshot(frame.screenshotPath);
+            appliedScreenshots = frame.screenshots;
+        }
+        if (frame.defragmentations != appliedDefragmentations) {
+            geometryPool.defragment();
+            appliedDefragmentations = frame.defragmentations;
+        }
+        applied = params;
+    };
+
+    // Render thread: counters of the frame just drawn, for the UI of a later frame
+    auto publishStats = [&](const FrameSnapshot& frame, std::chrono::steady_clock::time_point start) {
+        RenderStats& stats = renderStats.getWriteBuffer();
+        stats.frame = frame.frame;
+        stats.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.gpuMs = dynamicResolution.getGpuTime();
+        stats.shadowMapRenders = shadowMap.getRenderCount();
+        stats.clusterCount = clusteredLights.getClusterCount();
+        stats.lightIndexCount = clusteredLights.getLightIndexCount();
+        stats.maxLightsPerCluster = clusteredLights.getMaxLightsPerCluster();
+        stats.subMeshes = currentMesh.getSubMeshes().size();
+        stats.materials = currentMesh.getMaterials().size();
+        stats.vertexCount = currentMesh.getVertexCount();
+        stats.depthPrepassActive = depthPrepass.isActive();
+        stats.depthComplexity = depthPrepass.getDepthComplexity();
+        stats.shadedFragmentsPerPixel = depthPrepass.getShadedFragmentsPerPixel();
+        stats.shadedFragments = depthPrepass.getShadedFragments();
+        stats.resolutionScale = dynamicResolution.getScale();
+        stats.renderWidth = dynamicResolution.getRenderWidth();
+        stats.renderHeight = dynamicResolution.getRenderHeight();
+        stats.queue = renderQueue.getStats();
+        stats.recorderCount = renderQueue.getRecorderCount();
+        stats.viewCount = multiView.getViewCount();
+        std::copy(std::begin(visibleRenderables), std::end(visibleRenderables), stats.visibleRenderables);
+        stats.traversalMs = traversalMs;
+        stats.arena = frameArena.getStats();
+        stats.gl = GLEngine::GLStats::getFrame();
+        stats.jobsExecuted = jobSystem.getExecutedCount();
+        stats.jobsStolen = jobSystem.getStealCount();
+        stats.pool = geometryPool.getStats();
+        stats.poolFragmentation = geometryPool.getFragmentation();
+        stats.stream = streamBuffer.getStats();
+        stats.streamRegionCount = streamBuffer.getRegionCount();
+        stats.streamRegionSize = streamBuffer.getRegionSize();
+        stats.textureCount = textureCache.getTextureCount();
+        stats.residentTextures = textureCache.getResidentCount();
+        stats.pendingTextures = textureCache.getPendingCount();
+        stats.textureMemory = textureCache.getGpuMemory();
+        stats.textureUploaded = textureCache.getUploadedLastFrame();
+        stats.textureDecodes = textureCache.getDecodeCount();
+        stats.textureDuplicates = textureCache.getDedupCount();
+        stats.textureEvictions = textureCache.getEvictionCount();
+        stats.meshCount = meshResidency.getMeshCount();
+        stats.evictedMeshes = meshResidency.getEvictedCount();
+        stats.meshEvictions = meshResidency.getEvictionCount();
+        stats.meshRestores = meshResidency.getRestoreCount();
+        stats.driverMemory = GLEngine::GpuMemory::queryDriver(stats.driver);
+        stats.capturedFrames = frameCapture.getCapturedFrames();
+        stats.encodedFrames = frameCapture.getEncodedFrames();
+        stats.droppedFrames = frameCapture.getDroppedFrames();
+        stats.failedFrames = frameCapture.getFailedFrames();
+        stats.pendingEncodes = frameCapture.getPendingEncodes();
+        stats.videoStreaming = videoStream.isStreaming();
+        stats.videoWidth = videoStream.getWidth();
+        stats.videoHeight = videoStream.getHeight();
+        stats.videoWritten = videoStream.getFramesWritten();
+        stats.videoDropped = videoStream.getFramesDropped();
+        stats.videoThroughput = videoStream.getThroughput();
+        stats.videoConvertMs = videoStream.getConvertTime();
+        stats.videoError = videoStream.hasError();
+        renderStats.publish();
+    };
+
+    // Render thread: draws the latest published frame
+    auto renderFrame = [&]() {
+        const FrameSnapshot& frame = snapshots.getReadBuffer();
+        drawnFrame = &frame;
+        const FrameParameters& params = frame.parameters;
+        auto renderStart = std::chrono::steady_clock::now();
+        GLENGINE_TRACE_ZONE("Render Frame");
+        frameArena.beginFrame();
+        applyParameters(frame);
+
+        // The scene goes to the scaled offscreen target, ImGui stays at native resolution
+        dynamicResolution.beginFrame(frame.width, frame.height);
+        const unsigned int sceneFramebuffer = dynamicResolution.getFramebuffer();
+        const int renderWidth = dynamicResolution.getRenderWidth();
+        const int renderHeight = dynamicResolution.getRenderHeight();
+
+        // Per-frame GPU data goes to the ring region the GPU released regionCount frames ago
+        streamBuffer.beginFrame();
+
+        // Finished decodes are uploaded within the streaming budget
+        textureCache.update();
+        if (textureCache.getPendingCount() > 0) {
+            redrawScheduler.invalidateAsync(GLEngine::RedrawScheduler::Source::RESOURCE);
+        }
+
+        glClearColor(params.backgroundColor[0], params.backgroundColor[1], params.backgroundColor[2], 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glm::mat4 model = glm::mat4(1.0f);
-        glm::mat4 view = orbitalCamera.getViewMatrix();
-        glm::mat4 projection = glm::perspective(orbitalCamera.getFov(), 
-            (float)SCR_WIDTH / (float)SCR_HEIGHT, NEAR_PLANE, FAR_PLANE);
-
-        // Draw grid if enabled
-        if (showGrid) {
-            gridShader.use();
-            gridShader.setMat4("view", view);
-            gridShader.setMat4("projection", projection);
-            gridShader.setMat4("model", glm::mat4(1.0f));
-            grid.draw(view, projection);
-        }
-        
-        switch (currentLightingMode) {
-            case LightingMode::NONE:
-                objectShader = basicShader;
-                break;
-            case LightingMode::PHONG:
-                objectShader = phongShader;
-                break;
-            case LightingMode::BLINN_PHONG:
-                objectShader = blinnPhongShader;
-                break;
-            case LightingMode::GAUSSIAN:
-                objectShader = gaussianShader;
-                break;
+        scene.update();
+
+        renderables.clear();
+        if (params.showAllModels) {
+            for (size_t i = 0; i < galleryMeshes.size(); i++) {
+                renderables.emplace_back(galleryMeshes[i].get(), galleryNodes[i]);
+            }
+        } else {
+            renderables.emplace_back(&currentMesh, objectNode);
         }
+        const glm::vec3 lightPos(params.lightPosition[0], params.lightPosition[1], params.lightPosition[2]);
+        const glm::vec3 lightColor(params.lightColor[0], params.lightColor[1], params.lightColor[2]);
 
-        objectShader.use();
-        objectShader.setMat4("model", model);
-        objectShader.setMat4("view", view);
-        objectShader.setMat4("projection", projection);
+        // Camera blocks of every view, uploaded once; the views split the scaled target
+        const GLEngine::OrbitalCamera* cameras[GLEngine::MultiView::MAX_VIEWS];
+        for (unsigned int v = 0; v < GLEngine::MultiView::MAX_VIEWS; v++) {
+            cameras[v] = &frame.cameras[v];
+        }
+        multiView.beginFrame((GLEngine::MultiView::Layout)params.viewLayout, cameras, renderWidth, renderHeight);
+        const unsigned int viewCount = multiView.getViewCount();
 
-        switch (currentLightingMode) {
-            case LightingMode::NONE:
-                basicShader.setVec3("objectColor", glm::vec3(objectColor[0], objectColor[1], objectColor[2]));
-                break;
+        // Point lights were animated by the main thread
+        std::vector<GLEngine::PointLight>& lights = clusteredLights.getLights();
+        lights = frame.lights;
 
-            case LightingMode::PHONG:
-                phongShader.setVec3("lightPos", glm::vec3(lightPos[0], lightPos[1], lightPos[2]));
-                phongShader.setVec3("viewPos", orbitalCamera.getPosition());
-                phongShader.setVec3("lightColor", glm::vec3(lightColor[0], lightColor[1], lightColor[2]));
-                phongShader.setVec3("objectColor", glm::vec3(objectColor[0], objectColor[1], objectColor[2]));
-                phongShader.setFloat("shininess", shininess);
-                phongShader.setFloat("ambientStrength", ambientStrength);
-                phongShader.setFloat("specularStrength", specularStrength);
-                break;
+        // The shadow map is only re-rendered when the light, the mesh or a transform changed
+        bool castShadows = params.showShadows && params.lightingMode != LightingMode::NONE;
+        shadowLight = lightPos;
+        shadowReach = castShadows ? shadowMap.getFarPlane() : 0.0f;
+        if (castShadows) {
+            GLENGINE_TRACE_ZONE("Shadow Pass");
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            shadowMap.render(lightPos, scene.getRevision() + geometryRevision, drawShadowCasters);
+        }
 
-            case LightingMode::BLINN_PHONG:
-                blinnPhongShader.setVec3("lightPos", glm::vec3(lightPos[0], lightPos[1], lightPos[2]));
-                blinnPhongShader.setVec3("viewPos", orbitalCamera.getPosition());
-                blinnPhongShader.setVec3("lightColor", glm::vec3(lightColor[0], lightColor[1], lightColor[2]));
-                blinnPhongShader.setVec3("objectColor", glm::vec3(objectColor[0], objectColor[1], objectColor[2]));
-                blinnPhongShader.setFloat("shininess", shininess);
-                blinnPhongShader.setFloat("ambientStrength", ambientStrength);
-                blinnPhongShader.setFloat("specularStrength", specularStrength);
-                break;
+        bool deferredShading =
+            params.lightingMode == LightingMode::DEFERRED_PHONG ||
+            params.lightingMode == LightingMode::DEFERRED_BLINN_PHONG ||
+            params.lightingMode == LightingMode::DEFERRED_GAUSSIAN;
 
-            case LightingMode::GAUSSIAN:
-                gaussianShader.setVec3("lightPos", glm::vec3(lightPos[0], lightPos[1], lightPos[2]));
-                gaussianShader.setVec3("viewPos", orbitalCamera.getPosition());
-                gaussianShader.setVec3("lightColor", glm::vec3(lightColor[0], lightColor[1], lightColor[2]));
-                gaussianShader.setVec3("objectColor", glm::vec3(objectColor[0], objectColor[1], objectColor[2]));
-                gaussianShader.setFloat("shininess", shininess);
-                gaussianShader.setFloat("ambientStrength", ambientStrength);
-                gaussianShader.setFloat("specularStrength", specularStrength);
-                break;
+        if (deferredShading) {
+            GLENGINE_TRACE_ZONE("Deferred Pass");
+            // Geometry pass
+            gbuffer.resize(frame.width, frame.height);
+            gbuffer.setRenderSize(renderWidth, renderHeight);
+            gbuffer.bindForWriting();
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            gbufferShader.use();
+            recordScene(RENDER_PASS_GBUFFER, gbufferShader);
+
+            glPolygonMode(GL_FRONT_AND_BACK, params.showWireframe ? GL_LINE : GL_FILL);
+            for (unsigned int v = 0; v < viewCount; v++) {
+                multiView.bind(v);
+                renderQueue.execute(stateCache, viewPass(RENDER_PASS_GBUFFER, v), [](const GLEngine::Shader&) {}, applyMaterial);
+            }
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+            // Lighting pass, one fullscreen triangle per view for the scene light
+            glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+            glDisable(GL_DEPTH_TEST);
+            glDepthMask(GL_FALSE);
+
+            deferredShader.use();
+            gbuffer.bindTextures(0);
+            deferredShader.setInt("gNormal", 0);
+            deferredShader.setInt("gAlbedo", 1);
+            deferredShader.setInt("gDepth", 2);
+            deferredShader.setInt("gMaterial", 3);
+            deferredShader.setInt("specularModel", (int)params.lightingMode - (int)LightingMode::DEFERRED_PHONG);
+            shadowMap.bind(4);
+            deferredShader.setInt("shadowMap", 4);
+            deferredShader.setBool("shadowsEnabled", castShadows);
+            deferredShader.setVec2("shadowDepthRange", glm::vec2(shadowMap.getNearPlane(), shadowMap.getFarPlane()));
+
+            for (unsigned int v = 0; v < viewCount; v++) {
+                const GLEngine::OrbitalCamera& camera = multiView.getCamera(v);
+                const glm::ivec4& viewRect = multiView.getRect(v);
+                multiView.bind(v);
+                deferredShader.setVec4("texCoordRect", gbuffer.getTexCoordRect(viewRect));
+                deferredShader.setMat4("invViewProjection", glm::inverse(camera.getViewProjectionMatrix()));
+                deferredShader.setVec3("viewPos", camera.getPosition());
+                deferredShader.setVec3("lightPos", lightPos);
+                deferredShader.setVec3("lightColor", lightColor);
+                deferredShader.setFloat("lightRadius", 0.0f);
+                deferredShader.setFloat("ambientStrength", params.ambientStrength);
+                gbuffer.drawFullscreen();
+
+                // Point lights are accumulated additively, each restricted to its rectangle inside the view
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_ONE, GL_ONE);
+                deferredShader.setFloat("ambientStrength", 0.0f);
+                for (const auto& light : lights) {
+                    glm::ivec4 rect;
+                    if (!GLEngine::computeLightScissor(light.position, light.radius, camera.getViewMatrix(),
+                        camera.getProjectionMatrix(), viewRect.z, viewRect.w, rect)) {
+                        continue;
+                    }
+                    glScissor(viewRect.x + rect.x, viewRect.y + rect.y, rect.z, rect.w);
+                    deferredShader.setVec3("lightPos", light.position);
+                    deferredShader.setVec3("lightColor", light.color * light.intensity);
+                    deferredShader.setFloat("lightRadius", light.radius);
+                    gbuffer.drawFullscreen();
+                }
+                glDisable(GL_BLEND);
+            }
+
+            // Forward overlays depth-test against the G-buffer depth; the blit is scissored too
+            multiView.endFrame();
+            gbuffer.blitDepthTo(sceneFramebuffer);
+            glDepthMask(GL_TRUE);
+            glEnable(GL_DEPTH_TEST);
+        } else {
+            objectShader = params.lightingMode == LightingMode::NONE ? basicShader : forwardShader;
+            recordScene(RENDER_PASS_FORWARD, objectShader);
+
+            // Optional depth pre-pass so the lighting shaders run once per visible pixel
+            if (depthPrepass.beginFrame(!params.showWireframe)) {
+                GLENGINE_TRACE_ZONE("Depth Pre-pass");
+                depthPrepass.beginDepthPass();
+                prepassShader.use();
+                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+                for (unsigned int v = 0; v < viewCount; v++) {
+                    multiView.bind(v);
+                    for (size_t i = 0; i < renderables.size(); i++) {
+                        if (renderableVisible[i] & (1u << v)) {
+                            prepassShader.setMat4("model", scene.getWorldMatrix(renderables[i].second));
+                            renderables[i].first->drawDepthOnly();
+                        }
+                    }
+                }
+                depthPrepass.endDepthPass();
+            }
+
+            GLENGINE_TRACE_ZONE("Forward Pass");
+            objectShader.use();
+            // Clusters are perspective froxels: built for the perspective view, orthographic views get the scene light only
+            unsigned int clusterView = viewCount;
+            if (params.lightingMode != LightingMode::NONE) {
+                for (unsigned int v = 0; v < viewCount && clusterView == viewCount; v++) {
+                    if (!multiView.getCamera(v).isOrthographic()) {
+                        clusterView = v;
+                    }
+                }
+                if (!lights.empty() && clusterView < viewCount) {
+                    const GLEngine::OrbitalCamera& camera = multiView.getCamera(clusterView);
+                    clusteredLights.build(camera.getViewMatrix(), camera.getFov(), camera.getAspect(), NEAR_PLANE, FAR_PLANE);
+                    if (!clusteredLights.upload(streamBuffer)) {
+                        // The ring grows on the next frame, which must then be drawn
+                        redrawScheduler.invalidateAsync(GLEngine::RedrawScheduler::Source::RESOURCE);
+                    }
+                }
+
+                shadowMap.bind(3);
+                objectShader.setInt("shadowMap", 3);
+                objectShader.setBool("shadowsEnabled", castShadows);
+                objectShader.setVec2("shadowDepthRange", glm::vec2(shadowMap.getNearPlane(), shadowMap.getFarPlane()));
+
+                objectShader.setVec3("lightPos", lightPos);
+                objectShader.setVec3("lightColor", lightColor);
+                objectShader.setFloat("ambientStrength", params.ambientStrength);
+                objectShader.setInt("specularModel", (int)params.lightingMode - (int)LightingMode::PHONG);
+            }
+
+            glPolygonMode(GL_FRONT_AND_BACK, params.showWireframe ? GL_LINE : GL_FILL);
+            depthPrepass.beginShadingPass();
+            for (unsigned int v = 0; v < viewCount; v++) {
+                multiView.bind(v);
+                if (params.lightingMode != LightingMode::NONE) {
+                    objectShader.use();
+                    clusteredLights.bind(objectShader, 0, multiView.getRect(v));
+                    if (v != clusterView) {
+                        objectShader.setInt("pointLightCount", 0);
+                    }
+                }
+                renderQueue.execute(stateCache, viewPass(RENDER_PASS_FORWARD, v), [](const GLEngine::Shader&) {}, applyMaterial);
+            }
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            depthPrepass.endShadingPass();
+        }
+
+        // Overlays, view by view
+        for (unsigned int v = 0; v < viewCount; v++) {
+            multiView.bind(v);
+            if (params.showGrid) {
+                GLENGINE_TRACE_ZONE("Grid Pass");
+                gridShader.use();
+                gridShader.setMat4("model", glm::mat4(1.0f));
+                grid.draw(multiView.getCamera(v).getViewMatrix(), multiView.getCamera(v).getProjectionMatrix());
+            }
+
+            if (params.lightingMode != LightingMode::NONE) {
+                lightShader.use();
+                lightShader.setMat4("model", scene.getWorldMatrix(lightNode));
+                lightShader.setVec3("lightColor", lightColor);
+                lightCube.draw();
+            }
+
+            if (params.showNormals) {
+                GLENGINE_TRACE_ZONE("Normals Pass");
+                normalShader.use();
+                normalShader.setFloat("normalLength", params.normalLength);
+                for (size_t i = 0; i < renderables.size(); i++) {
+                    if (renderableVisible[i] & (1u << v)) {
+                        normalShader.setMat4("model", scene.getWorldMatrix(renderables[i].second));
+                        normalShader.setMat3("normalMatrix", scene.getNormalMatrix(renderables[i].second));
+                        renderables[i].first->drawNormals(params.normalStep);
+                    }
+                }
+            }
+        }
+        multiView.endFrame();
+
+        streamBuffer.endFrame();
+        dynamicResolution.endFrame();
+        dynamicResolution.present(upscaleShader);
+
+        // Captures read the upscaled scene back before ImGui draws over it
+        frameCapture.capture(frame.width, frame.height);
+        videoStream.capture(frame.width, frame.height);
+        if (frameCapture.hasPendingReadbacks()) {
+            redrawScheduler.invalidateAsync(GLEngine::RedrawScheduler::Source::RESOURCE);
         }
 
-        glPolygonMode(GL_FRONT_AND_BACK, showWireframe ? GL_LINE : GL_FILL);
-        currentMesh.draw();
+        {
+            GLENGINE_TRACE_ZONE("ImGui Pass");
+            // The backend only reads the draw data
+            ImGui_ImplOpenGL3_RenderDrawData(const_cast<ImDrawData*>(&frame.ui.data));
+        }
+
+        if (meshResidency.update()) {
+            geometryRevision++;
+            redrawScheduler.invalidateAsync(GLEngine::RedrawScheduler::Source::RESOURCE);
+        }
+
+        {
+            GLENGINE_TRACE_ZONE("glfwSwapBuffers");
+            glfwSwapBuffers(window);
+        }
+        GLEngine::GLStats::endFrame();
+        publishStats(frame, renderStart);
+        drawnFrame = nullptr;
+    };
+
+    // Everything above was created with the context current here; from now on only the render thread uses it
+    glfwMakeContextCurrent(NULL);
+    renderThread.start([&]() { glfwMakeContextCurrent(window); }, [&]() { return snapshots.update(); }, renderFrame,
+        [&]() { glfwMakeContextCurrent(NULL); });
+
+    // Only the render thread waits for vsync: the interactive loop ticks at the refresh rate on its own
+    const GLFWvidmode* videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    const auto tickPeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / (videoMode && videoMode->refreshRate > 0 ? videoMode->refreshRate : 60)));
+    auto nextTick = std::chrono::steady_clock::now();
+
+    uint64_t frameIndex = 0;
+    double mainFrameMs = 0.0;
+    while (!glfwWindowShouldClose(window)) {
+        if (replaying) {
+            // Every recorded frame is drawn, window input is ignored
+            glfwPollEvents();
+        } else {
+            std::this_thread::sleep_until(nextTick);
+            nextTick = std::max(nextTick + tickPeriod, std::chrono::steady_clock::now());
+            redrawScheduler.waitEvents();
+            if (!redrawScheduler.beginFrame()) {
+                continue;
+            }
+        }
 
-        if (currentLightingMode != LightingMode::NONE) {
-            lightShader.use();
-            glm::mat4 lightModel = glm::mat4(1.0f);
-            lightModel = glm::translate(lightModel, glm::vec3(lightPos[0], lightPos[1], lightPos[2]));
-            lightShader.setMat4("model", lightModel);
-            lightShader.setMat4("view", view);
-            lightShader.setMat4("projection", projection);
-            lightShader.setVec3("lightColor", glm::vec3(lightColor[0], lightColor[1], lightColor[2]));
-            lightCube.draw();
+        // Applies the recorded input and parameters of this frame when replaying
+        double frameTime = glfwGetTime();
+        if (!session.beginFrame(orbitalCamera, frameTime)) {
+            break;
+        }
+        if (replaying && !replayFast) {
+            if (session.getFrameCount() == 1) {
+                replayStart = std::chrono::steady_clock::now();
+                replayFirstTime = frameTime;
+            }
+            std::this_thread::sleep_until(replayStart +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(frameTime - replayFirstTime)));
         }
+        auto frameStart = std::chrono::steady_clock::now();
+        GLENGINE_TRACE_ZONE("Frame");
 
-        if (showNormals) {
-            normalShader.use();
-            normalShader.setMat4("model", model);
-            normalShader.setMat4("view", view);
-            normalShader.setMat4("projection", projection);
-            normalShader.setFloat("normalLength", normalLength);
-            currentMesh.draw();
+        GLEngine::processInput(window);
+
+        // Counters of the last frame the render thread finished, one or two frames old
+        renderStats.update();
+        const RenderStats& rendered = renderStats.getReadBuffer();
+        if (parameters.dynamicResolution && rendered.frame > 0) {
+            parameters.resolutionScale = rendered.resolutionScale;
+        }
+
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+
+        int fbWidth, fbHeight;
+        glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+
+        // Mouse input gathered since the last frame moves the camera once
+        orbitalCamera.update();
+
+        // Every view follows the perspective camera; orthographic ones frame its focus plane from far enough
+        // to see the whole scene
+        auto viewLayout = (GLEngine::MultiView::Layout)parameters.viewLayout;
+        const unsigned int viewCount = GLEngine::MultiView::getViewCount(viewLayout);
+        GLEngine::OrbitalCamera* viewCameras[GLEngine::MultiView::MAX_VIEWS] = { &orbitalCamera };
+        if (viewLayout == GLEngine::MultiView::Layout::QUAD) {
+            glm::vec3 focus = orbitalCamera.getFocus();
+            float halfHeight = glm::length(orbitalCamera.getPosition() - focus) * std::tan(orbitalCamera.getFov() * 0.5f);
+            const glm::vec3 axes[3] = { glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f) };
+            GLEngine::OrbitalCamera* orthographic[3] = { &topCamera, &frontCamera, &sideCamera };
+            for (int i = 0; i < 3; i++) {
+                orthographic[i]->setLookAt(focus + axes[i] * (FAR_PLANE * 0.5f), focus);
+                orthographic[i]->setOrthographic(halfHeight);
+                orthographic[i]->setClipPlanes(NEAR_PLANE, FAR_PLANE);
+                viewCameras[i] = orthographic[i];
+            }
+            viewCameras[3] = &orbitalCamera;
+        }
+        for (unsigned int v = 0; v < viewCount; v++) {
+            glm::ivec4 rect = GLEngine::MultiView::getRect(viewLayout, v, fbWidth, fbHeight);
+            viewCameras[v]->setViewport(rect.z, rect.w);
         }
 
         int width, height;
         glfwGetWindowSize(window, &width, &height);
-        
+
         // ImGui
         ImGui::SetNextWindowPos(ImVec2(width * 0.75f, 0), ImGuiCond_Always);
         ImGui::SetNextWindowSize(ImVec2(width * 0.25f, height), ImGuiCond_Always);
-        
-        ImGui::Begin("Rendering Parameters", nullptr, 
+
+        ImGui::Begin("Rendering Parameters", nullptr,
             ImGuiWindowFlags_NoMove |
             ImGuiWindowFlags_NoResize |
             ImGuiWindowFlags_NoCollapse |
@@ -279,83 +1202,558 @@ int main() {
         glm::vec3 camPos = orbitalCamera.getPosition();
         ImGui::Text("Camera position: (%.2f, %.2f, %.2f)", camPos.x, camPos.y, camPos.z);
 
-        ImGui::ColorEdit3("Background Color", backgroundColor);
+        ImGui::ColorEdit3("Background Color", parameters.backgroundColor);
+
+        ImGui::Checkbox("Show Grid", &parameters.showGrid);
+
+        const char* viewLayouts[] = { "Single", "Top / Front / Side / Perspective" };
+        ImGui::Combo("Views", &parameters.viewLayout, viewLayouts, IM_ARRAYSIZE(viewLayouts));
+        if (viewCount > 1) {
+            // Labels in the corner of each view, under the ImGui windows
+            const char* viewNames[GLEngine::MultiView::MAX_VIEWS] = { "Top", "Front", "Side", "Perspective" };
+            ImDrawList* labels = ImGui::GetBackgroundDrawList();
+            for (unsigned int v = 0; v < viewCount; v++) {
+                glm::ivec4 rect = GLEngine::MultiView::getRect(viewLayout, v, width, height);
+                labels->AddText(ImVec2(rect.x + 8.0f, height - rect.y - rect.w + 8.0f), IM_COL32_WHITE, viewNames[v]);
+            }
+        }
 
-        ImGui::Checkbox("Show Grid", &showGrid);
-        
         if (ImGui::CollapsingHeader("Light")) {
-            const char* lighting_modes[] = { "None", "Phong", "Blinn-Phong", "Gaussian" };
+            const char* lighting_modes[] = { "None", "Phong", "Blinn-Phong", "Gaussian",
+                "Deferred Phong", "Deferred Blinn-Phong", "Deferred Gaussian" };
             int current_mode = static_cast<int>(currentLightingMode);
             if (ImGui::Combo("Lighting Mode", &current_mode, lighting_modes, IM_ARRAYSIZE(lighting_modes))) {
                 currentLightingMode = static_cast<LightingMode>(current_mode);
+                applyLightingMode();
             }
 
-            if (
-                currentLightingMode == LightingMode::PHONG ||
-                currentLightingMode == LightingMode::BLINN_PHONG ||
-                currentLightingMode == LightingMode::GAUSSIAN
-            ) {
-                ImGui::DragFloat3("Light Position", lightPos, 0.1f);
-                ImGui::ColorEdit3("Light Color", lightColor);
-                ImGui::SliderFloat("Ambient Strength", &ambientStrength, 0.0f, 1.0f);
-                ImGui::SliderFloat("Specular Strength", &specularStrength, 0.0f, 1.0f);
-                ImGui::SliderFloat("Shininess", &shininess, 1.0f, 256.0f);
+            if (currentLightingMode != LightingMode::NONE) {
+                ImGui::DragFloat3("Light Position", parameters.lightPosition, 0.1f);
+                ImGui::ColorEdit3("Light Color", parameters.lightColor);
+                ImGui::SliderFloat("Ambient Strength", &parameters.ambientStrength, 0.0f, 1.0f);
+                ImGui::SliderFloat("Specular Strength", &parameters.specularStrength, 0.0f, 1.0f);
+                ImGui::SliderFloat("Shininess", &parameters.shininess, 1.0f, 256.0f);
+                ImGui::Checkbox("Shadows", &parameters.showShadows);
+                ImGui::SameLine();
+                ImGui::Text("(shadow map renders: %llu)", (unsigned long long)rendered.shadowMapRenders);
+
+                bool lightsChanged = ImGui::SliderInt("Point Lights", &pointLightCount, 0, 1024);
+                lightsChanged |= ImGui::SliderFloat("Point Light Radius", &pointLightRadius, 0.05f, 2.0f);
+                if (lightsChanged) {
+                    applyPointLights();
+                }
+                ImGui::Checkbox("Animate Point Lights", &animatePointLights);
+                ImGui::Text("Clusters: %u, light indices: %zu, max per cluster: %u",
+                    rendered.clusterCount, rendered.lightIndexCount, rendered.maxLightsPerCluster);
             }
         }
 
         if (ImGui::CollapsingHeader("Object")) {
-            if (ImGui::Combo("3D Model", &currentItem, 
+            if (ImGui::Combo("3D Model", &currentItem,
                 [](void* data, int idx, const char** out_text) {
                     std::vector<std::string>* files = (std::vector<std::string>*)data;
                     if (idx < 0 || (size_t)idx >= files->size()) return false;
                     *out_text = (*files)[idx].c_str();
                     return true;
-                }, 
-                &objFiles, objFiles.size())) 
+                },
+                &objFiles, objFiles.size()))
             {
-                std::string newObjPath = objectsDir + objFiles[currentItem];
-                if (newObjPath != currentObjPath) {
-                    currentMesh.loadFromFile(newObjPath);
-                    currentObjPath = newObjPath;
+                applyModel();
+            }
+            // Listed on demand, not every frame
+            if (ImGui::Button("Rescan Models")) {
+                objFiles = GLEngine::Mesh::getObjFiles(objectsDir);
+            }
+            ImGui::Text("Submeshes: %zu, materials: %zu", rendered.subMeshes, rendered.materials);
+            ImGui::Checkbox("Show All Models", &parameters.showAllModels);
+            ImGui::Checkbox("Show Wireframe", &parameters.showWireframe);
+            ImGui::ColorEdit3("Object Color", parameters.objectColor);
+            // Edited aside, the texture is only loaded on Enter
+            if (ImGui::InputText("Diffuse Texture", diffuseTextureInput, sizeof(diffuseTextureInput),
+                ImGuiInputTextFlags_EnterReturnsTrue)) {
+                std::memcpy(parameters.diffuseTexture, diffuseTextureInput, sizeof(parameters.diffuseTexture));
+            }
+            ImGui::Checkbox("Show Normals", &parameters.showNormals);
+            if (parameters.showNormals) {
+                ImGui::SliderFloat("Normal Length", &parameters.normalLength, 0.01f, 1.0f);
+                ImGui::SliderInt("Normal Decimation", &parameters.normalStep, 1, 64);
+                ImGui::Text("Normals drawn: %zu", (rendered.vertexCount + parameters.normalStep - 1) / parameters.normalStep);
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Performance")) {
+            if (ImGui::Checkbox("Render On Demand", &renderOnDemand)) {
+                redrawScheduler.setEnabled(renderOnDemand);
+            }
+            ImGui::Text("Frames rendered: %llu, skipped: %llu",
+                (unsigned long long)redrawScheduler.getFramesRendered(),
+                (unsigned long long)redrawScheduler.getFramesSkipped());
+            ImGui::Text("Main thread: %.2f ms (%.2f ms waiting), render thread: %.2f ms, %llu frames behind",
+                mainFrameMs, renderThread.getLastWaitMs(), rendered.cpuMs,
+                (unsigned long long)(frameIndex - rendered.frame));
+            ImGui::Text("Snapshots dropped: %llu", (unsigned long long)snapshots.getDroppedCount());
+
+            const char* prepassModes[] = { "Off", "On", "Auto" };
+            ImGui::Combo("Depth Pre-pass", &parameters.depthPrepassMode, prepassModes, IM_ARRAYSIZE(prepassModes));
+            ImGui::SliderFloat("Overdraw Threshold", &parameters.depthPrepassThreshold, 1.0f, 4.0f);
+            ImGui::Text("Pre-pass %s, depth complexity: %.2f", rendered.depthPrepassActive ? "active" : "inactive",
+                rendered.depthComplexity);
+            ImGui::Text("Shaded fragments per pixel: %.2f (%llu fragments)", rendered.shadedFragmentsPerPixel,
+                (unsigned long long)rendered.shadedFragments);
+
+            ImGui::Checkbox("Dynamic Resolution", &parameters.dynamicResolution);
+            ImGui::SliderFloat("GPU Budget (ms)", &parameters.gpuBudget, 2.0f, 33.0f);
+            // Dragging the scale overrides the automatic control
+            if (ImGui::SliderFloat("Resolution Scale", &parameters.resolutionScale, minResolutionScale, maxResolutionScale)) {
+                parameters.dynamicResolution = false;
+            }
+            ImGui::SliderFloat("Upscale Sharpness", &parameters.upscaleSharpness, 0.0f, 1.0f);
+            ImGui::Text("Scene GPU time: %.2f ms, render size: %dx%d", rendered.gpuMs,
+                rendered.renderWidth, rendered.renderHeight);
+
+            const GLEngine::RenderQueue::Stats& queueStats = rendered.queue;
+            ImGui::Text("Draw calls: %zu for %zu packets, state changes: %zu program, %zu material, %zu transform",
+                queueStats.drawCalls, queueStats.packets, queueStats.programBinds, queueStats.materialChanges,
+                queueStats.transformChanges);
+            ImGui::Text("VAO binds: %zu, queue sort: %.3f ms on %u recorders", queueStats.vaoBinds, queueStats.sortMs,
+                rendered.recorderCount);
+            ImGui::Text("Scene traversal: %.3f ms for %u views, visible per view: %zu %zu %zu %zu", rendered.traversalMs,
+                rendered.viewCount, rendered.visibleRenderables[0], rendered.visibleRenderables[1],
+                rendered.visibleRenderables[2], rendered.visibleRenderables[3]);
+            const GLEngine::FrameArena::Stats& arenaStats = rendered.arena;
+            ImGui::Text("Frame arena: %.1f KB used, high water %.1f KB, capacity %.1f KB, %llu overflows",
+                arenaStats.used / 1024.0, arenaStats.highWater / 1024.0, arenaStats.capacity / 1024.0,
+                (unsigned long long)arenaStats.overflows);
+
+            if (GLEngine::GLStats::isEnabled()) {
+                const GLEngine::GLStats::Counters& glFrame = rendered.gl;
+                ImGui::Text("GL calls: %llu, draws: %llu, triangles: %llu", (unsigned long long)glFrame.calls,
+                    (unsigned long long)glFrame.drawCalls, (unsigned long long)glFrame.triangles);
+                ImGui::Text("GL state changes: %llu, uniforms: %llu, uploads: %.1f KB buffers, %.1f KB textures",
+                    (unsigned long long)glFrame.stateChanges, (unsigned long long)glFrame.uniformUpdates,
+                    glFrame.bufferBytes / 1024.0, glFrame.textureBytes / 1024.0);
+                if (glFrame.errors > 0) {
+                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "GL errors: %llu",
+                        (unsigned long long)glFrame.errors);
+                }
+            } else {
+                ImGui::Text("GL call statistics disabled (GLENGINE_GL_STATS)");
+            }
+
+            if (GLEngine::AllocStats::isEnabled()) {
+                const GLEngine::AllocStats::Counters& allocFrame = GLEngine::AllocStats::getFrame();
+                ImGui::Text("Heap: %llu allocations, %llu frees, %.1f KB (max %llu allocations per frame)",
+                    (unsigned long long)allocFrame.allocations, (unsigned long long)allocFrame.frees,
+                    allocFrame.bytes / 1024.0, (unsigned long long)GLEngine::AllocStats::getMax().allocations);
+                if (ImGui::TreeNode("Allocations by zone and thread")) {
+                    for (const GLEngine::AllocStats::ZoneCounters& zone : GLEngine::AllocStats::getFrameZones()) {
+                        ImGui::Text("%-28s %6llu %9.1f KB", zone.zone ? zone.zone : "(no zone)",
+                            (unsigned long long)zone.counters.allocations, zone.counters.bytes / 1024.0);
+                    }
+                    ImGui::Separator();
+                    for (const GLEngine::AllocStats::ThreadCounters& thread : GLEngine::AllocStats::getFrameThreads()) {
+                        ImGui::Text("%-28s %6llu %9.1f KB", thread.name,
+                            (unsigned long long)thread.counters.allocations, thread.counters.bytes / 1024.0);
+                    }
+                    ImGui::TreePop();
                 }
+            } else {
+                ImGui::Text("Heap allocation statistics disabled (GLENGINE_ALLOC_STATS)");
+            }
+
+            ImGui::Text("Jobs: %u threads, %llu run, %llu stolen", jobThreadCount,
+                (unsigned long long)rendered.jobsExecuted, (unsigned long long)rendered.jobsStolen);
+            // Blocks the UI for a moment, each thread count gets its own short-lived system
+            if (ImGui::Button("Run Job Benchmark")) {
+                jobBenchmark = runJobBenchmark(jobThreadCount);
+            }
+            for (const JobBenchmarkResult& result : jobBenchmark) {
+                ImGui::Text("  %u threads: %.2f ms, speedup %.2fx, busy %.0f%%, steals %llu", result.threads, result.ms,
+                    jobBenchmark[0].ms / result.ms, result.utilization * 100.0, result.steals);
+            }
+
+#ifdef GLENGINE_TRACE
+            if (ImGui::Button("Export Trace")) {
+                GLEngine::Trace::write("captures/trace_" + captureTimestamp() + ".json");
+            }
+            ImGui::SameLine();
+            ImGui::Text("%llu trace events buffered", (unsigned long long)GLEngine::Trace::getEventCount());
+#endif
+
+            const GLEngine::GeometryPool::Stats& poolStats = rendered.pool;
+            ImGui::Text("Geometry pool: %zu meshes, vertices %zu / %zu, indices %zu / %zu",
+                poolStats.allocations, poolStats.vertexUsed, poolStats.vertexCapacity,
+                poolStats.indexUsed, poolStats.indexCapacity);
+            ImGui::Text("Free blocks: %zu, fragmentation: %.0f%%, grows: %llu, defragmentations: %llu",
+                poolStats.freeBlocks, rendered.poolFragmentation * 100.0f,
+                (unsigned long long)poolStats.grows, (unsigned long long)poolStats.defragmentations);
+            if (ImGui::Button("Defragment Geometry")) {
+                defragmentRequests++;
+            }
+
+            if (GLEngine::StreamBuffer::isPersistentMappingSupported()) {
+                ImGui::Checkbox("Persistent Stream Mapping", &parameters.persistentStreamMapping);
+            } else {
+                ImGui::Text("Persistent mapping unavailable (no ARB_buffer_storage)");
+            }
+            const GLEngine::StreamBuffer::Stats& streamStats = rendered.stream;
+            ImGui::Text("Stream: %.1f KB this frame, %.1f MB total, %u x %.1f MB regions, overflows: %llu, map failures: %llu",
+                streamStats.bytesLastFrame / 1024.0, streamStats.bytesStreamed / (1024.0 * 1024.0),
+                rendered.streamRegionCount, rendered.streamRegionSize / (1024.0 * 1024.0),
+                (unsigned long long)streamStats.overflows, (unsigned long long)streamStats.mapFailures);
+            ImGui::Text("Fence waits: %llu, last %.3f ms, total %.1f ms", (unsigned long long)streamStats.fenceWaits,
+                streamStats.lastWaitMs, streamStats.totalWaitMs);
+
+            ImGui::SliderInt("Texture Budget (MB)", &parameters.textureBudgetMB, 16, 4096);
+            ImGui::Text("Textures: %zu (%zu resident, %zu pending), %.1f MB on GPU",
+                rendered.textureCount, rendered.residentTextures, rendered.pendingTextures,
+                rendered.textureMemory / (1024.0 * 1024.0));
+            ImGui::Text("Decodes: %llu, duplicates: %llu, evictions: %llu, uploaded: %.1f MB",
+                (unsigned long long)rendered.textureDecodes, (unsigned long long)rendered.textureDuplicates,
+                (unsigned long long)rendered.textureEvictions, rendered.textureUploaded / (1024.0 * 1024.0));
+
+            for (size_t i = 0; i < (size_t)GLEngine::RedrawScheduler::Source::COUNT; i++) {
+                auto source = (GLEngine::RedrawScheduler::Source)i;
+                ImGui::Text("  %s invalidations: %llu", GLEngine::RedrawScheduler::getSourceName(source),
+                    (unsigned long long)redrawScheduler.getCount(source));
             }
-            ImGui::Checkbox("Show Wireframe", &showWireframe);
-            ImGui::ColorEdit3("Object Color", objectColor);
-            ImGui::Checkbox("Show Normals", &showNormals);
+        }
+
+        if (ImGui::CollapsingHeader("GPU Memory")) {
+            ImGui::Text("Tracked: %.1f MB in %zu resources", GLEngine::GpuMemory::getTotal() / (1024.0 * 1024.0),
+                GLEngine::GpuMemory::getResourceCount());
+            for (size_t i = 0; i < (size_t)GLEngine::GpuMemory::Category::COUNT; i++) {
+                auto category = (GLEngine::GpuMemory::Category)i;
+                ImGui::Text("  %s: %.1f MB", GLEngine::GpuMemory::getCategoryName(category),
+                    GLEngine::GpuMemory::getTotal(category) / (1024.0 * 1024.0));
+            }
+            if (rendered.driverMemory) {
+                ImGui::Text("Driver (%s): %.0f MB available of %.0f MB", rendered.driver.source,
+                    rendered.driver.availableBytes / (1024.0 * 1024.0), rendered.driver.totalBytes / (1024.0 * 1024.0));
+            } else {
+                ImGui::Text("Driver memory info unavailable");
+            }
+
+            // 0 leaves the total unbounded, the texture budget above still applies to textures
+            if (ImGui::SliderInt("GPU Budget (MB)", &gpuBudgetMB, 0, 4096)) {
+                GLEngine::GpuMemory::setBudget((size_t)gpuBudgetMB << 20);
+            }
+            ImGui::Text("Meshes: %zu tracked, %zu evicted, evictions: %llu, restores: %llu%s",
+                rendered.meshCount, rendered.evictedMeshes, (unsigned long long)rendered.meshEvictions,
+                (unsigned long long)rendered.meshRestores, GLEngine::GpuMemory::isOverBudget() ? " (over budget)" : "");
+
+            if (ImGui::TreeNode("Resources")) {
+                GLEngine::GpuMemory::getResources(gpuResources);
+                for (const GLEngine::GpuMemory::Resource& resource : gpuResources) {
+                    ImGui::Text("%-28s %-15s %9.2f MB", resource.owner.c_str(),
+                        GLEngine::GpuMemory::getCategoryName(resource.category), resource.bytes / (1024.0 * 1024.0));
+                }
+                ImGui::TreePop();
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Capture")) {
+            const char* captureFormats[] = { "PNG", "JPEG" };
+            ImGui::Combo("Format", &parameters.captureFormat, captureFormats, IM_ARRAYSIZE(captureFormats));
+            auto format = (GLEngine::FrameCapture::Format)parameters.captureFormat;
+            if (ImGui::Button("Screenshot")) {
+                screenshotPath = "captures/screenshot_" + captureTimestamp() +
+                    (format == GLEngine::FrameCapture::Format::JPEG ? ".jpg" : ".png");
+                screenshotRequests++;
+            }
+            ImGui::SameLine();
+            if (ImGui::Checkbox("Record", &parameters.recordFrames) && parameters.recordFrames) {
+                recordingPath = "captures/recording_" + captureTimestamp();
+            }
+            ImGui::Text("Captured: %llu, encoded: %llu, dropped: %llu, failed: %llu",
+                (unsigned long long)rendered.capturedFrames,
+                (unsigned long long)rendered.encodedFrames,
+                (unsigned long long)rendered.droppedFrames,
+                (unsigned long long)rendered.failedFrames);
+            ImGui::Text("Pending encodes: %zu", rendered.pendingEncodes);
+
+            bool recordingSession = session.isRecording();
+            if (!replaying && ImGui::Checkbox("Record Session", &recordingSession)) {
+                if (recordingSession) {
+                    session.startRecording("captures/session_" + captureTimestamp() + ".glsession", orbitalCamera,
+                        fbWidth, fbHeight);
+                } else {
+                    session.stop();
+                }
+            }
+            if (session.getMode() != GLEngine::Session::Mode::IDLE) {
+                ImGui::Text("Session %s: %llu frames, %.1f KB", replaying ? "replay" : "recording",
+                    (unsigned long long)session.getFrameCount(), session.getBytesWritten() / 1024.0);
+            }
+
+            ImGui::InputText("Stream Path", parameters.streamPath, sizeof(parameters.streamPath));
+            if (ImGui::Button(parameters.streaming ? "Stop Stream" : "Start Stream")) {
+                parameters.streaming = !parameters.streaming;
+            }
+            if (rendered.videoStreaming) {
+                ImGui::Text("y4m %dx%d: written %llu, dropped %llu, %.1f MB/s, convert %.2f ms%s",
+                    rendered.videoWidth, rendered.videoHeight,
+                    (unsigned long long)rendered.videoWritten,
+                    (unsigned long long)rendered.videoDropped,
+                    rendered.videoThroughput, rendered.videoConvertMs,
+                    rendered.videoError ? " (write error)" : "");
+            }
+        }
+        redrawScheduler.setAnimating((animatePointLights && pointLightCount > 0 &&
+            currentLightingMode != LightingMode::NONE) || parameters.recordFrames || parameters.streaming);
+
+        // Active widgets (held sliders, text fields) keep the UI refreshing
+        if (ImGui::IsAnyItemActive()) {
+            redrawScheduler.invalidate(GLEngine::RedrawScheduler::Source::UI);
         }
 
         ImGui::End();
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // Written into the slot the render thread does not read, published once complete
+        FrameSnapshot& snapshot = snapshots.getWriteBuffer();
+        snapshot.frame = ++frameIndex;
+        snapshot.width = fbWidth;
+        snapshot.height = fbHeight;
+        for (unsigned int v = 0; v < viewCount; v++) {
+            snapshot.cameras[v] = *viewCameras[v];
+        }
+        snapshot.parameters = parameters;
+        snapshot.modelPath = currentObjPath;
+        snapshot.screenshots = screenshotRequests;
+        snapshot.screenshotPath = screenshotPath;
+        snapshot.recordingPath = recordingPath;
+        snapshot.defragmentations = defragmentRequests;
+
+        // Point lights orbit around the Y axis when animated
+        snapshot.lights = pointLights;
+        if (animatePointLights) {
+            glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), (float)frameTime * 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
+            for (auto& light : snapshot.lights) {
+                light.position = glm::vec3(rotation * glm::vec4(light.position, 1.0f));
+            }
+        }
+        {
+            GLENGINE_TRACE_ZONE("ImGui::Render");
+            ImGui::Render();
+            copyDrawData(*ImGui::GetDrawData(), snapshot.ui);
+        }
+
+        // A replay draws every recorded frame, so the previous one must be taken before this one replaces it;
+        // interactively the main thread never waits and a frame still unread when the next is published is dropped
+        if (replaying) {
+            renderThread.waitForPickup();
+        }
+        snapshots.publish();
+        renderThread.submit();
+
+        GLEngine::AllocStats::endFrame();
+        // Replays include the wait for the render thread, so they run at the pace of the slower one; the GPU
+        // time is the last one measured
+        mainFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        {
+            // The session keeps every frame time, its growth is measurement overhead
+            GLEngine::AllocStats::Exclude exclude;
+            session.endFrame(mainFrameMs, rendered.gpuMs);
+        }
+
+        if (allocCheckFrames >= 0) {
+            // Loading models, textures or resizing targets allocates; only settled frames are checked
+            if (session.getParameterChangeCount() != allocCheckChanges) {
+                allocCheckChanges = session.getParameterChangeCount();
+                allocCheckSettled = 0;
+            }
+            if (allocCheckSettled++ >= allocCheckFrames) {
+                allocCheckedFrames++;
+                const GLEngine::AllocStats::Counters& allocFrame = GLEngine::AllocStats::getFrame();
+                if (allocFrame.allocations > 0) {
+                    allocCheckFailures++;
+                    std::cerr << "ERROR::ALLOC::STEADY_FRAME_ALLOCATED: frame " << GLEngine::AllocStats::getFrameCount()
+                        << ", " << allocFrame.allocations << " allocations, " << allocFrame.bytes << " bytes" << std::endl;
+                    for (const GLEngine::AllocStats::ZoneCounters& zone : GLEngine::AllocStats::getFrameZones()) {
+                        std::cerr << "  " << (zone.zone ? zone.zone : "(no zone)") << ": " << zone.counters.allocations
+                            << " allocations, " << zone.counters.bytes << " bytes" << std::endl;
+                    }
+                }
+            }
+        }
+    }
+
+    // Frames already submitted are still drawn, then the context comes back for the cleanup
+    renderThread.stop();
+    glfwMakeContextCurrent(window);
+
+    if (!y4mPath.empty()) {
+        // Whole-run throughput, measured without a window with --replay-fast
+        videoStream.stop();
+        double seconds = videoStream.getElapsedTime();
+        std::cout << std::fixed << std::setprecision(3)
+            << "y4m: " << videoStream.getWidth() << "x" << videoStream.getHeight() << ", frames written "
+            << videoStream.getFramesWritten() << ", dropped " << videoStream.getFramesDropped()
+            << ", fps " << (seconds > 0.0 ? videoStream.getFramesWritten() / seconds : 0.0)
+            << ", MB/s " << videoStream.getThroughput() << ", convert ms " << videoStream.getConvertTime()
+            << (videoStream.hasError() ? ", write error" : "") << std::endl;
+    }
+    if (replaying) {
+        session.printSummary(std::cout);
+        if (!timingsPath.empty()) {
+            session.writeTimings(timingsPath);
+        }
     }
+    if (!benchmarkPath.empty()) {
+        std::ofstream benchmark(benchmarkPath, std::ios::trunc);
+        benchmark << "{\"timings\":";
+        session.writeSummaryJson(benchmark);
+        benchmark << ",\n\"gl\":";
+        GLEngine::GLStats::writeJson(benchmark);
+        benchmark << ",\n\"alloc\":";
+        GLEngine::AllocStats::writeJson(benchmark);
+        benchmark << "}\n";
+        if (!benchmark) {
+            std::cerr << "ERROR::BENCHMARK::WRITE_FAILED: " << benchmarkPath << std::endl;
+        }
+    }
+    session.stop();
+    if (allocCheckFrames >= 0) {
+        std::cout << "Allocation check: " << allocCheckedFrames << " steady frames, " << allocCheckFailures
+            << " allocated" << std::endl;
+    }
+#ifdef GLENGINE_TRACE
+    if (!tracePath.empty()) {
+        GLEngine::Trace::write(tracePath);
+    }
+#endif
 
+    meshResidency.clear();
     currentMesh.cleanup();
+    for (auto& mesh : galleryMeshes) {
+        mesh->cleanup();
+    }
+    geometryPool.cleanup();
+    streamBuffer.cleanup();
     grid.cleanup();
     lightCube.cleanup();
+    clusteredLights.cleanup();
+    multiView.cleanup();
+    gbuffer.cleanup();
+    shadowMap.cleanup();
+    depthPrepass.cleanup();
+    dynamicResolution.cleanup();
+    frameCapture.cleanup();
+    videoStream.cleanup();
+    textureCache.cleanup();
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 
     glfwTerminate();
-    return 0;
+    return allocCheckFailures > 0 ? 1 : 0;
+}
+
+void generatePointLights(std::vector<GLEngine::PointLight>& lights, int count, float radius) {
+    // Fixed seed so the same count always gives the same layout
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-1.5f, 1.5f);
+    std::uniform_real_distribution<float> channel(0.2f, 1.0f);
+
+    lights.resize(count);
+    for (auto& light : lights) {
+        light.position = glm::vec3(position(rng), position(rng) * 0.5f + 0.5f, position(rng));
+        light.radius = radius;
+        light.color = glm::vec3(channel(rng), channel(rng), channel(rng));
+        light.intensity = 1.0f;
+    }
+}
+
+// Buffers are resized in place, a steady UI copies without allocating
+void copyDrawData(const ImDrawData& source, UiDrawData& target) {
+    ImDrawData& data = target.data;
+    data.Clear();
+    for (int i = 0; i < source.CmdListsCount; i++) {
+        const ImDrawList& list = *source.CmdLists[i];
+        if ((size_t)i == target.lists.size()) {
+            target.lists.push_back(std::make_unique<ImDrawList>(list._Data));
+        }
+        ImDrawList& copy = *target.lists[i];
+        copy.CmdBuffer.resize(list.CmdBuffer.Size);
+        std::memcpy(copy.CmdBuffer.Data, list.CmdBuffer.Data, list.CmdBuffer.size_in_bytes());
+        copy.IdxBuffer.resize(list.IdxBuffer.Size);
+        std::memcpy(copy.IdxBuffer.Data, list.IdxBuffer.Data, list.IdxBuffer.size_in_bytes());
+        copy.VtxBuffer.resize(list.VtxBuffer.Size);
+        std::memcpy(copy.VtxBuffer.Data, list.VtxBuffer.Data, list.VtxBuffer.size_in_bytes());
+        copy.Flags = list.Flags;
+        data.CmdLists.push_back(&copy);
+    }
+    data.CmdListsCount = source.CmdListsCount;
+    data.TotalIdxCount = source.TotalIdxCount;
+    data.TotalVtxCount = source.TotalVtxCount;
+    data.DisplayPos = source.DisplayPos;
+    data.DisplaySize = source.DisplaySize;
+    data.FramebufferScale = source.FramebufferScale;
+    data.Valid = source.Valid;
+}
+
+std::string captureTimestamp() {
+    char buffer[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(buffer, sizeof(buffer), "%Y%m%d_%H%M%S", std::localtime(&now));
+    return buffer;
+}
+
+// Same parallelFor over 1 to maxThreads threads; the trace hook sums the time spent inside jobs
+std::vector<JobBenchmarkResult> runJobBenchmark(unsigned int maxThreads) {
+    const size_t count = 1 << 20;
+    std::vector<glm::vec3> points(count);
+    for (size_t i = 0; i < count; i++) {
+        points[i] = glm::vec3((float)i, (float)(i % 97), 1.0f);
+    }
+    std::vector<glm::vec3> normals(count);
+    const glm::mat4 transform = glm::rotate(glm::mat4(1.0f), 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
+
+    std::vector<JobBenchmarkResult> results;
+    for (unsigned int threads = 1; threads <= std::max(maxThreads, 1u); threads++) {
+        GLEngine::JobSystem jobs(threads - 1);
+        std::atomic<uint64_t> busyNs(0);
+        jobs.setTraceHook([](const char*, unsigned int, uint64_t start, uint64_t end, void* user) {
+            ((std::atomic<uint64_t>*)user)->fetch_add(end - start, std::memory_order_relaxed);
+        }, &busyNs);
+
+        JobBenchmarkResult result = { threads, 1e9, 0.0, 0 };
+        for (int run = 0; run < 3; run++) {
+            busyNs = 0;
+            auto start = std::chrono::steady_clock::now();
+            jobs.parallelFor(count, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; i++) {
+                    normals[i] = glm::normalize(glm::vec3(transform * glm::vec4(points[i], 1.0f)));
+                }
+            }, 4096, "benchmark");
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (ms < result.ms) {
+                // Only the caller's first chunk runs outside a job, and a single thread runs inline
+                result.ms = ms;
+                result.utilization = threads > 1 ? busyNs / (ms * 1e6 * threads) : 1.0;
+            }
+        }
+        result.steals = (unsigned long long)jobs.getStealCount();
+        results.push_back(result);
+    }
+    return results;
 }
 
 void onMouseButton(GLFWwindow* window, int button, int action, int mods) {
+    redrawScheduler.invalidate(GLEngine::RedrawScheduler::Source::INPUT);
+
     if (action == GLFW_RELEASE) {
         mouseButtonState = MousePressedButton::NONE;
     } else {
         switch (button) {
-            case GLFW_MOUSE_BUTTON_LEFT: 
+            case GLFW_MOUSE_BUTTON_LEFT:
                 mouseButtonState = MousePressedButton::LEFT;
                 break;
-            case GLFW_MOUSE_BUTTON_RIGHT: 
+            case GLFW_MOUSE_BUTTON_RIGHT:
                 mouseButtonState = MousePressedButton::RIGHT;
                 break;
-            case GLFW_MOUSE_BUTTON_MIDDLE: 
+            case GLFW_MOUSE_BUTTON_MIDDLE:
                 mouseButtonState = MousePressedButton::MIDDLE;
                 break;
         }
@@ -363,6 +1761,8 @@ void onMouseButton(GLFWwindow* window, int button, int action, int mods) {
 }
 
 void onMouseMove(GLFWwindow* window, double xpos, double ypos) {
+    redrawScheduler.invalidate(GLEngine::RedrawScheduler::Source::INPUT);
+
     if (!ImGui::GetIO().WantCaptureMouse) {
         if (mouseButtonState == MousePressedButton::NONE) {
             lastX = (float)xpos;
@@ -381,15 +1781,15 @@ void onMouseMove(GLFWwindow* window, double xpos, double ypos) {
             lastY = (float)ypos;
 
             switch (mouseButtonState) {
-                case MousePressedButton::LEFT: 
-                    orbitalCamera.orbit(xoffset, yoffset);
+                case MousePressedButton::LEFT:
+                    session.cameraInput(orbitalCamera, GLEngine::Session::CameraInput::ORBIT, xoffset, yoffset);
                     break;
                 case MousePressedButton::RIGHT:
-                    orbitalCamera.track(xoffset);
-                    orbitalCamera.pedestal(yoffset);
+                    session.cameraInput(orbitalCamera, GLEngine::Session::CameraInput::TRACK, xoffset);
+                    session.cameraInput(orbitalCamera, GLEngine::Session::CameraInput::PEDESTAL, yoffset);
                     break;
-                case MousePressedButton::MIDDLE: 
-                    orbitalCamera.dolly(yoffset);
+                case MousePressedButton::MIDDLE:
+                    session.cameraInput(orbitalCamera, GLEngine::Session::CameraInput::DOLLY, yoffset);
                     break;
                 case MousePressedButton::NONE:
                     break;
@@ -399,7 +1799,22 @@ void onMouseMove(GLFWwindow* window, double xpos, double ypos) {
 }
 
 void onMouseScroll(GLFWwindow* window, double xoffset, double yoffset) {
+    redrawScheduler.invalidate(GLEngine::RedrawScheduler::Source::INPUT);
+
     if (!ImGui::GetIO().WantCaptureMouse) {
-        orbitalCamera.zoom((float)yoffset);
+        session.cameraInput(orbitalCamera, GLEngine::Session::CameraInput::ZOOM, (float)yoffset);
     }
+}
+
+void onKey(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    redrawScheduler.invalidate(GLEngine::RedrawScheduler::Source::INPUT);
+}
+
+// The render thread owns the context and sets its viewports every frame
+void onFramebufferSize(GLFWwindow* window, int width, int height) {
+    redrawScheduler.invalidate(GLEngine::RedrawScheduler::Source::RESIZE);
+}
+
+void onWindowRefresh(GLFWwindow* window) {
+    redrawScheduler.invalidate(GLEngine::RedrawScheduler::Source::RESIZE);
 }
\ No newline at end of file